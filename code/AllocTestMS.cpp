@@ -0,0 +1,166 @@
+#include "MailslotPool.h"
+#include "MailslotTransport.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+
+// ------------------------------
+// AllocTestMS: zero-allocation check for the pooled receive path
+// Replaces operator new / delete (and malloc / calloc / realloc on glibc)
+// with counting versions, then drives N receives (default 1000000) through
+// a slot into MailslotPool blocks held by MailslotMessageView handles, as
+// the servers do. The last views are kept in a ring, so blocks outlive the
+// loop iteration and are returned when they are overwritten.
+// After a short warm-up (first-use allocations of the transport and the
+// stream library are allowed there), the heap must not be touched: the
+// program prints the allocation count and exits with 1 if it is not 0.
+// Usage: AllocTestMS [--count N] [--shm]
+//   --count N  receives to check (default 1000000)
+//   --shm      use the shared-memory ring instead of the kernel slot
+// ------------------------------
+
+static std::atomic<uint64_t> allocations{0};    // heap allocations so far
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+
+#if defined(__GLIBC__)
+// malloc family: glibc exports the real allocator as __libc_*, so plain C
+// allocations (inside the transport or the C library) are counted as well.
+// operator new above calls malloc, so it is counted twice — any count > 0
+// fails the check either way.
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* memory, size_t size);
+extern "C" void* malloc(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+extern "C" void* calloc(size_t count, size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+extern "C" void* realloc(void* memory, size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(memory, size);
+}
+#endif
+
+static const uint32_t kRetained = 256;          // views kept past their iteration
+static const uint32_t kSendBatch = 8;           // below the Linux datagram queue length (10)
+
+int main(int argc, char* argv[]) {
+    MailslotInitConsole();                      // Console code page
+
+    uint64_t count = 1000000;
+    MailslotMode mode = MAILSLOT_MODE_KERNEL;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--count" && i + 1 < argc) {
+            count = strtoull(argv[++i], NULL, 10);
+        } else if (arg == "--shm") {
+            mode = MAILSLOT_MODE_SHARED_MEMORY;
+        } else {
+            std::cout << "Usage: AllocTestMS [--count N] [--shm]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Block 1: slot, sender and pool — the only allocations of the program
+    const std::string name = MailslotLocalName("AllocTest");
+    MailslotServer server;
+    if (!MailslotCreate(server, name, 300, 2000, mode)) {
+        HandleMailslotError("CreateMailslot");
+        return 1;
+    }
+    MailslotSender sender;
+    if (!MailslotOpenSender(sender, name, mode)) {
+        HandleMailslotError("CreateFile");
+        MailslotClose(server);
+        return 1;
+    }
+    MailslotPool pool(kRetained + MAILSLOT_BATCH_MAX, MailslotMaxMessageSize(server));
+    static MailslotMessageView retained[kRetained];
+    static char payload[kSendBatch][64];
+    MailslotMessage outgoing[kSendBatch];
+    MailslotMessage batch[MAILSLOT_BATCH_MAX];
+    MailslotMessageView views[MAILSLOT_BATCH_MAX];
+
+    // Block 2: send a small batch, receive it into pooled views, keep them
+    uint64_t received = 0, sequence = 0, nextSend = 0, mismatched = 0, before = 0;
+    const uint64_t warmUp = 1000;
+    bool failed = false, steadyState = false;
+    while (received < warmUp + count) {
+        if (received >= warmUp && !steadyState) {   // steady state from here
+            before = allocations.load();
+            steadyState = true;
+        }
+        for (uint32_t i = 0; i < kSendBatch; i++) {
+            outgoing[i].buffer = payload[i];
+            outgoing[i].length = (uint32_t)snprintf(payload[i], sizeof(payload[i]), "message %llu",
+                                                    (unsigned long long)(nextSend + i));
+            outgoing[i].capacity = sizeof(payload[i]);
+        }
+        uint32_t sent = 0;
+        if (!MailslotSendMany(sender, outgoing, kSendBatch, &sent) && MailslotLastError() != MAILSLOT_ERROR_BUSY) {
+            HandleMailslotError("WriteFile");
+            failed = true;
+            break;
+        }
+        nextSend += sent;
+
+        uint32_t slots = 0;
+        while (slots < sent && (views[slots] = MailslotPoolAcquire(pool))) {
+            batch[slots].buffer = views[slots].Data();
+            batch[slots].capacity = views[slots].Capacity();
+            slots++;
+        }
+        uint32_t got = 0;
+        if (slots > 0 && !MailslotReceiveMany(server, batch, slots, &got)) {
+            HandleMailslotError("ReadFile");
+            failed = true;
+            break;
+        }
+        for (uint32_t i = 0; i < got; i++) {
+            views[i].SetLength(batch[i].length);
+            char expected[64];
+            int length = snprintf(expected, sizeof(expected), "message %llu", (unsigned long long)sequence++);
+            if (views[i].Length() != (uint32_t)length || memcmp(views[i].Data(), expected, length) != 0) mismatched++;
+            retained[received++ % kRetained] = std::move(views[i]);   // releases the oldest view
+        }
+        for (uint32_t i = got; i < slots; i++) views[i].Reset();     // the rest arrive next round
+    }
+    uint64_t steady = allocations.load() - before;
+
+    // Block 3: report
+    uint32_t highWater = pool.HighWater();
+    for (uint32_t i = 0; i < kRetained; i++) retained[i].Reset();
+    uint32_t leaked = pool.InUse();
+    MailslotClose(sender);
+    MailslotClose(server);
+    if (failed) return 1;
+    std::cout << "Receives: " << received - warmUp << " (after " << warmUp << " warm-up), mismatched: "
+              << mismatched << std::endl;
+    std::cout << "Pool: high-water " << highWater << " / " << pool.BlockCount() << ", in use after release: "
+              << leaked << std::endl;
+    std::cout << "Heap allocations in steady state: " << steady << std::endl;
+    bool passed = steady == 0 && mismatched == 0 && leaked == 0;
+    std::cout << (passed ? "PASS" : "FAIL") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,1027 @@
+#include "MailslotCompress.h"
+#include "MailslotFragment.h"
+#include "MailslotFrame.h"
+#include "MailslotHistogram.h"
+#include "MailslotPriority.h"
+#include "MailslotStartup.h"
+#include "MailslotRouter.h"
+#include "MailslotTransport.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+extern char** environ;
+#endif
+
+// ------------------------------
+// BenchMS: end-to-end mailslot latency benchmark
+// Every message carries its sender id, sequence number and send timestamp;
+// the receiver records per-message latency into an HDR-style histogram and
+// counts lost and reordered messages.
+//
+// Usage: BenchMS [--role both|server|client] [--slot NAME] [--shm]
+//                [--size BYTES] [--count N] [--senders N]
+//                [--rate MSG_PER_S | --closed-loop WINDOW]
+//                [--timeout MS] [--scale [MAX]] [--routes [MAX]] [--json]
+//                [--priority [--work-us US] [--deadline-ms MS]]
+//                [--startup [N] [--pin CPU]]
+//   --role         both   — receiver and senders in one process (default)
+//                  server — receiver only; client — senders only
+//   --size         message size in bytes (>= 24, <= slot max 300)
+//   --count        messages per sender (default 100000)
+//   --senders      sender threads (default 1)
+//   --rate         open loop: messages per second per sender (0 — unpaced);
+//                  latency is measured from the scheduled send time
+//   --closed-loop  at most WINDOW unacknowledged messages per sender
+//                  (role both only)
+//   --timeout      receiver stops after this idle time (default 2000 ms)
+//   --scale        sweep 1, 2, 4 ... MAX sender threads (1..64, default 64) against
+//                  one receiver: aggregate msg/s, per-sender fairness, drop
+//                  and error rates per step (role both only)
+//   --routes       routing table cost: match --count messages against 1, 10,
+//                  100 ... MAX rules (default 1000; half frame types, half
+//                  payload prefixes, see MailslotRouter.h); no slot involved
+//   --priority     control latency under bulk load: --senders bulk threads
+//                  send --count frames each while one thread sends a control
+//                  frame every millisecond; the receiver spends --work-us per
+//                  message (default 5). Runs a single FIFO slot, strict and
+//                  weighted lanes (see MailslotPriority.h) and compares
+//                  control latency; bulk frames carry --deadline-ms (default
+//                  0 — none) and expired ones are dropped unhandled
+//   --startup      time to first message: starts this program again as a
+//                  receiver process, cold or warm (buffers and pools
+//                  prefaulted, message path run once, --pin CPU; see
+//                  MailslotStartup.h), waits for its readiness pipe and sends
+//                  N compressed frames (default 1000, one per 100 us or
+//                  --rate); the receiver reports spawn-to-ready time, the
+//                  first message's latency, first-N latency and page faults
+//   --json         machine-readable report on stdout
+// ------------------------------
+
+const uint32_t BENCH_MAGIC = 0x48434E42;     // "BNCH"
+const uint32_t BENCH_MAX_MESSAGE = 300;      // slot nMaxMessage
+
+// Header at the start of every benchmark message
+struct BenchHeader {
+    uint32_t magic;
+    uint32_t sender;                          // sender thread index
+    uint64_t sequence;                        // per sender, from 0
+    uint64_t sendTimeNs;                      // MailslotNowNs at (scheduled) send
+};
+
+struct BenchConfig {
+    std::string role = "both";
+    std::string slot = "Bench";
+    MailslotMode mode = MAILSLOT_MODE_KERNEL;
+    uint32_t size = 64;
+    uint64_t count = 100000;
+    uint32_t senders = 1;
+    double rate = 0;                          // per sender, 0 — unpaced
+    uint32_t window = 0;                      // closed loop, 0 — open loop
+    uint32_t timeoutMs = 2000;
+    uint32_t scaleMax = 0;                    // --scale: largest sender count
+    uint32_t routesMax = 0;                   // --routes: largest rule count
+    bool priority = false;                    // --priority: lanes vs one FIFO slot
+    uint32_t workUs = 5;                      // --priority: handling cost per message
+    uint32_t deadlineMs = 0;                  // --priority: bulk deadline (0 — none)
+    uint32_t startupMessages = 0;             // --startup: first-N messages measured
+    int pinCpu = -1;                          // --startup: warm receiver's CPU
+    std::string startupChild;                 // internal: receiver process mode (cold / warm)
+    uint64_t spawnNs = 0;                     // internal: when the parent started the receiver
+    intptr_t readyFd = -1;                    // internal: readiness pipe of the receiver
+    bool json = false;
+};
+
+struct BenchResult {
+    // Sender side
+    uint64_t sent = 0;
+    uint64_t sendErrors = 0;
+    double sendSeconds = 0;
+    // Receiver side
+    uint64_t received = 0;
+    uint64_t lost = 0;
+    uint64_t reordered = 0;
+    uint64_t foreign = 0;                     // datagrams without a bench header
+    uint64_t dropped = 0;                     // dropped by the receiving slot (oversize)
+    double receiveSeconds = 0;                // first to last message
+    std::vector<uint64_t> perSender;          // messages received per sender
+    std::vector<double> senderSeconds;        // send loop duration per sender
+    MailslotHistogram latency;                // ns
+};
+
+// Shared state between the receiver and the senders (role both)
+struct BenchShared {
+    std::unique_ptr<std::atomic<uint64_t>[]> acked;   // received per sender
+    std::atomic<bool> receiverReady{false};
+};
+
+// ------------------------------
+// Receiver
+// ------------------------------
+void RunReceiver(const BenchConfig& config, MailslotServer& server, BenchShared* shared, BenchResult* result) {
+    struct Track {
+        uint64_t expected = 0;                // next in-order sequence
+        uint64_t received = 0;
+        uint64_t maxSequence = 0;
+    };
+    std::vector<Track> tracks(config.senders);
+    result->perSender.assign(config.senders, 0);
+    MailslotHistogramReset(result->latency);
+
+    static char buffers[MAILSLOT_BATCH_MAX][BENCH_MAX_MESSAGE];
+    MailslotMessage batch[MAILSLOT_BATCH_MAX];
+    for (uint32_t i = 0; i < MAILSLOT_BATCH_MAX; i++) {
+        batch[i].buffer = buffers[i];
+        batch[i].capacity = sizeof(buffers[i]);
+    }
+
+    uint64_t expectedTotal = config.role == "both" ? config.count * config.senders : 0;
+    uint64_t firstNs = 0, lastNs = 0;
+    // Role server waits for external clients indefinitely; with in-process
+    // senders the first message is due at once, so a sender that failed to
+    // open cannot hang the run
+    uint32_t waitMs = config.role == "both" ? config.timeoutMs : MAILSLOT_WAIT_FOREVER;
+    if (shared != nullptr) shared->receiverReady.store(true);
+
+    while (expectedTotal == 0 || result->received < expectedTotal) {
+        uint32_t received = 0;
+        if (!MailslotReceiveMany(server, batch, MAILSLOT_BATCH_MAX, &received, waitMs)) {
+            if (MailslotLastError() != MAILSLOT_ERROR_TIMEOUT) HandleMailslotError("ReadFile");
+            break;
+        }
+        uint64_t nowNs = MailslotNowNs();
+        if (firstNs == 0) firstNs = nowNs;
+        lastNs = nowNs;
+        waitMs = config.timeoutMs;
+
+        for (uint32_t i = 0; i < received; i++) {
+            BenchHeader header;
+            if (batch[i].length < sizeof(header)) { result->foreign++; continue; }
+            memcpy(&header, batch[i].buffer, sizeof(header));
+            if (header.magic != BENCH_MAGIC || header.sender >= config.senders) { result->foreign++; continue; }
+
+            MailslotHistogramRecord(result->latency, nowNs > header.sendTimeNs ? nowNs - header.sendTimeNs : 0);
+            Track& track = tracks[header.sender];
+            if (header.sequence < track.expected) {
+                result->reordered++;          // arrived after a later one
+            } else {
+                track.expected = header.sequence + 1;
+            }
+            track.maxSequence = std::max(track.maxSequence, header.sequence);
+            track.received++;
+            result->received++;
+            result->perSender[header.sender]++;
+            if (shared != nullptr) shared->acked[header.sender].fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    result->receiveSeconds = (double)(lastNs - firstNs) / 1e9;
+    // Without the sender counts, loss is the gap up to the highest sequence seen
+    for (uint32_t s = 0; s < config.senders; s++) {
+        uint64_t sent = config.role == "both" ? config.count
+                                              : (tracks[s].received > 0 ? tracks[s].maxSequence + 1 : 0);
+        if (sent > tracks[s].received) result->lost += sent - tracks[s].received;
+    }
+}
+
+// ------------------------------
+// Sender thread
+// ------------------------------
+void RunSender(const BenchConfig& config, const std::string& name, uint32_t index, BenchShared* shared,
+               std::atomic<uint64_t>* sent, std::atomic<uint64_t>* errors, double* seconds) {
+    MailslotSender sender;
+    if (!MailslotOpenSender(sender, name, config.mode)) {
+        HandleMailslotError("CreateFile");
+        errors->fetch_add(config.count);
+        return;
+    }
+
+    char message[BENCH_MAX_MESSAGE];
+    memset(message, 'x', sizeof(message));
+    BenchHeader header = { BENCH_MAGIC, index, 0, 0 };
+    const uint64_t intervalNs = config.rate > 0 ? (uint64_t)(1e9 / config.rate) : 0;
+    const uint64_t startNs = MailslotNowNs();
+    uint64_t localSent = 0, localErrors = 0;
+
+    for (uint64_t i = 0; i < config.count; i++) {
+        // Closed loop: wait for the window to open (give up after the timeout)
+        if (config.window > 0) {
+            uint64_t waitStart = MailslotNowNs();
+            while (i - shared->acked[index].load(std::memory_order_acquire) >= config.window) {
+                if (MailslotNowNs() - waitStart > (uint64_t)config.timeoutMs * 1000000ULL) break;
+                std::this_thread::yield();
+            }
+        }
+        // Open loop: stamp the scheduled time, so stalls show up as latency
+        uint64_t sendTimeNs = 0;
+        if (intervalNs > 0) {
+            sendTimeNs = startNs + i * intervalNs;
+            while (MailslotNowNs() < sendTimeNs) {
+                if (sendTimeNs - MailslotNowNs() > 200000) std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        } else {
+            sendTimeNs = MailslotNowNs();
+        }
+
+        header.sequence = i;
+        header.sendTimeNs = sendTimeNs;
+        memcpy(message, &header, sizeof(header));
+        uint32_t bytesWritten = 0;
+        bool ok;
+        // A full shared-memory ring reports BUSY: wait for the reader like a
+        // blocking kernel send would, instead of counting it as lost
+        while (!(ok = MailslotSend(sender, message, config.size, &bytesWritten)) &&
+               MailslotLastError() == MAILSLOT_ERROR_BUSY) {
+            std::this_thread::yield();
+        }
+        if (ok) {
+            localSent++;
+        } else if (localErrors++ < 3) {
+            HandleMailslotError("WriteFile");
+        }
+    }
+    MailslotClose(sender);
+    *seconds = (double)(MailslotNowNs() - startNs) / 1e9;
+    sent->fetch_add(localSent);
+    errors->fetch_add(localErrors);
+}
+
+// ------------------------------
+// One benchmark run
+// ------------------------------
+bool RunBench(const BenchConfig& config, BenchResult* result) {
+    *result = BenchResult();
+    result->senderSeconds.assign(config.senders, 0);
+    std::string name = MailslotLocalName(config.slot);
+    bool receive = config.role != "client";
+    bool send = config.role != "server";
+
+    BenchShared shared;
+    shared.acked.reset(new std::atomic<uint64_t>[config.senders]);
+    for (uint32_t i = 0; i < config.senders; i++) shared.acked[i].store(0);
+
+    MailslotServer server;
+    if (receive && !MailslotCreate(server, name, BENCH_MAX_MESSAGE, config.timeoutMs, config.mode)) {
+        HandleMailslotError("CreateMailslot");
+        return false;
+    }
+    std::thread receiver;
+    if (receive && send) {
+        receiver = std::thread(RunReceiver, std::cref(config), std::ref(server), &shared, result);
+        while (!shared.receiverReady.load()) std::this_thread::yield();
+    }
+
+    if (send) {
+        std::atomic<uint64_t> sent{0}, errors{0};
+        std::vector<std::thread> senders;
+        uint64_t startNs = MailslotNowNs();
+        for (uint32_t i = 0; i < config.senders; i++) {
+            senders.emplace_back(RunSender, std::cref(config), std::cref(name), i,
+                                 config.window > 0 ? &shared : nullptr, &sent, &errors,
+                                 &result->senderSeconds[i]);
+        }
+        for (size_t i = 0; i < senders.size(); i++) senders[i].join();
+        result->sendSeconds = (double)(MailslotNowNs() - startNs) / 1e9;
+        result->sent = sent.load();
+        result->sendErrors = errors.load();
+    }
+
+    if (receive && send) {
+        receiver.join();
+        // Failed sends are errors, not losses
+        result->lost = result->sent > result->received ? result->sent - result->received : 0;
+    } else if (receive) {
+        RunReceiver(config, server, nullptr, result);
+    }
+    if (receive) {
+        result->dropped = server.oversizeDropped;
+        MailslotClose(server);
+    }
+    return true;
+}
+
+// ------------------------------
+// Reports
+// ------------------------------
+
+// Per-sender throughput spread and Jain's fairness index
+// (1.0 — all senders got the same rate, 1/N — one sender got everything)
+struct BenchFairness {
+    double minRate = 0;
+    double maxRate = 0;
+    double jain = 0;
+};
+
+BenchFairness ComputeFairness(const BenchResult& result) {
+    BenchFairness fairness;
+    double sum = 0, sumSquares = 0;
+    size_t senders = std::min(result.perSender.size(), result.senderSeconds.size());
+    for (size_t i = 0; i < senders; i++) {
+        double rate = result.senderSeconds[i] > 0 ? result.perSender[i] / result.senderSeconds[i] : 0;
+        fairness.minRate = i == 0 ? rate : std::min(fairness.minRate, rate);
+        fairness.maxRate = std::max(fairness.maxRate, rate);
+        sum += rate;
+        sumSquares += rate * rate;
+    }
+    if (sumSquares > 0) fairness.jain = sum * sum / (senders * sumSquares);
+    return fairness;
+}
+
+void PrintText(const BenchConfig& config, const BenchResult& result) {
+    std::cout << "\n========== BENCHMARK RESULTS ==========" << std::endl;
+    std::cout << "Role: " << config.role << ", size: " << config.size << " bytes, senders: " << config.senders
+              << ", " << (config.window > 0 ? "closed loop, window " + std::to_string(config.window)
+                          : config.rate > 0 ? "open loop, " + std::to_string((uint64_t)config.rate) + " msg/s per sender"
+                          : std::string("unpaced")) << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    if (config.role != "server") {
+        std::cout << "Sent: " << result.sent << ", errors: " << result.sendErrors
+                  << ", send rate: " << (result.sendSeconds > 0 ? result.sent / result.sendSeconds : 0) << " msg/s" << std::endl;
+    }
+    if (config.role != "client") {
+        double seconds = result.receiveSeconds > 0 ? result.receiveSeconds : 1e-9;
+        std::cout << "Received: " << result.received << ", lost: " << result.lost
+                  << ", reordered: " << result.reordered << ", dropped by slot: " << result.dropped << std::endl;
+        std::cout << "Receive rate: " << result.received / seconds << " msg/s, "
+                  << result.received * config.size / seconds << " B/s" << std::endl;
+        const MailslotHistogram& h = result.latency;
+        std::cout << "Latency (us): p50 " << MailslotHistogramPercentile(h, 50) / 1000.0
+                  << "  p99 " << MailslotHistogramPercentile(h, 99) / 1000.0
+                  << "  p99.9 " << MailslotHistogramPercentile(h, 99.9) / 1000.0
+                  << "  max " << h.max / 1000.0
+                  << "  mean " << MailslotHistogramMean(h) / 1000.0 << std::endl;
+    }
+    std::cout << "=======================================" << std::endl;
+}
+
+void PrintJson(const BenchConfig& config, const BenchResult& result) {
+    const MailslotHistogram& h = result.latency;
+    double seconds = result.receiveSeconds > 0 ? result.receiveSeconds : 1e-9;
+    char json[2048];
+    snprintf(json, sizeof(json),
+        "{\"role\":\"%s\",\"mode\":\"%s\",\"size\":%u,\"count\":%llu,\"senders\":%u,\"rate\":%.0f,\"window\":%u,"
+        "\"sent\":%llu,\"send_errors\":%llu,\"send_seconds\":%.6f,"
+        "\"received\":%llu,\"lost\":%llu,\"reordered\":%llu,\"receive_seconds\":%.6f,"
+        "\"msg_per_s\":%.2f,\"bytes_per_s\":%.2f,"
+        "\"latency_ns\":{\"min\":%llu,\"p50\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu,\"mean\":%.1f}}",
+        config.role.c_str(), config.mode == MAILSLOT_MODE_SHARED_MEMORY ? "shm" : "kernel",
+        config.size, (unsigned long long)config.count, config.senders, config.rate, config.window,
+        (unsigned long long)result.sent, (unsigned long long)result.sendErrors, result.sendSeconds,
+        (unsigned long long)result.received, (unsigned long long)result.lost,
+        (unsigned long long)result.reordered, result.receiveSeconds,
+        result.received / seconds, result.received * config.size / seconds,
+        (unsigned long long)(h.total ? h.min : 0),
+        (unsigned long long)MailslotHistogramPercentile(h, 50),
+        (unsigned long long)MailslotHistogramPercentile(h, 99),
+        (unsigned long long)MailslotHistogramPercentile(h, 99.9),
+        (unsigned long long)h.max, MailslotHistogramMean(h));
+    std::cout << json << std::endl;
+}
+
+// ------------------------------
+// Scaling sweep: 1, 2, 4 ... scaleMax senders, one receiver
+// ------------------------------
+int RunScale(BenchConfig config) {
+    static BenchResult result;
+    if (!config.json) {
+        std::cout << std::left << std::setw(8) << "Senders" << std::setw(14) << "msg/s"
+                  << std::setw(24) << "sender msg/s min..max" << std::setw(8) << "Jain"
+                  << std::setw(10) << "lost %" << std::setw(10) << "error %"
+                  << std::setw(10) << "drops" << "p99 us" << std::endl;
+    }
+    // Powers of two below scaleMax, then scaleMax itself
+    std::vector<uint32_t> steps;
+    for (uint32_t senders = 1; senders < config.scaleMax; senders *= 2) steps.push_back(senders);
+    steps.push_back(config.scaleMax);
+
+    bool clean = true;
+    for (uint32_t senders : steps) {
+        config.senders = senders;
+        if (!RunBench(config, &result)) return 1;
+        BenchFairness fairness = ComputeFairness(result);
+        double seconds = result.receiveSeconds > 0 ? result.receiveSeconds : 1e-9;
+        double attempts = (double)(result.sent + result.sendErrors);
+        double lostPct = result.sent > 0 ? 100.0 * result.lost / result.sent : 0;
+        double errorPct = attempts > 0 ? 100.0 * result.sendErrors / attempts : 0;
+        uint64_t p99 = MailslotHistogramPercentile(result.latency, 99);
+        if (result.lost > 0 || result.sendErrors > 0) clean = false;
+
+        if (config.json) {
+            char json[512];
+            snprintf(json, sizeof(json),
+                "{\"senders\":%u,\"sent\":%llu,\"received\":%llu,\"msg_per_s\":%.2f,"
+                "\"sender_min_msg_per_s\":%.2f,\"sender_max_msg_per_s\":%.2f,\"jain\":%.4f,"
+                "\"lost_pct\":%.4f,\"error_pct\":%.4f,\"dropped\":%llu,\"p99_ns\":%llu}",
+                senders, (unsigned long long)result.sent, (unsigned long long)result.received,
+                result.received / seconds, fairness.minRate, fairness.maxRate, fairness.jain,
+                lostPct, errorPct, (unsigned long long)result.dropped, (unsigned long long)p99);
+            std::cout << json << std::endl;
+        } else {
+            char range[64];
+            snprintf(range, sizeof(range), "%.0f..%.0f", fairness.minRate, fairness.maxRate);
+            std::cout << std::left << std::fixed << std::setprecision(0)
+                      << std::setw(8) << senders << std::setw(14) << result.received / seconds
+                      << std::setw(24) << range << std::setprecision(3) << std::setw(8) << fairness.jain
+                      << std::setw(10) << lostPct << std::setw(10) << errorPct
+                      << std::setw(10) << result.dropped << std::setprecision(1) << p99 / 1000.0 << std::endl;
+        }
+    }
+    return clean ? 0 : 1;
+}
+
+// ------------------------------
+// Routing sweep: match cost for 1, 10, 100 ... routesMax rules
+// Half of the messages hit a rule (by type or by prefix), half miss. Key
+// shape is the same at every step: prefixes are "svcNNNNN/" (9 bytes) and
+// a prefix miss is a rule's prefix with its last byte changed, so every
+// lookup walks a full 9-byte path and only the rule count varies.
+// ------------------------------
+int RunRoutes(const BenchConfig& config) {
+    if (!config.json) {
+        std::cout << std::left << std::setw(8) << "Rules" << std::setw(10) << "Routes" << std::setw(12) << "build ms"
+                  << std::setw(12) << "ns/match" << std::setw(12) << "matched %" << "trie nodes" << std::endl;
+    }
+    uint32_t seed = 12345;                    // deterministic rule set
+    auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return seed >> 8; };
+    for (uint32_t rules = 1;; rules *= 10) {
+        if (rules > config.routesMax) rules = config.routesMax;
+
+        // Block 1: rules — "svcNNNNN/" prefixes and frame types over 50 routes
+        std::vector<MailslotRouteRule> table;
+        std::vector<std::string> prefixes;
+        std::vector<std::string> messages;
+        std::vector<uint32_t> types;
+        for (uint32_t i = 0; i < rules; i++) {
+            MailslotRouteRule rule;
+            rule.route = "route" + std::to_string(i % 50);
+            if (i % 2 == 0) {
+                char prefix[16];
+                snprintf(prefix, sizeof(prefix), "svc%05u/", next() % 100000);
+                rule.prefix = prefix;
+                prefixes.push_back(rule.prefix);
+            } else {
+                rule.byType = true;
+                rule.type = (uint16_t)(next() % 60000);
+            }
+            table.push_back(rule);
+        }
+        for (uint32_t i = 0; i < 1024; i++) {
+            const MailslotRouteRule& rule = table[next() % table.size()];
+            bool hit = i % 2 == 0;
+            std::string key = prefixes[next() % prefixes.size()];
+            if (hit && !rule.byType) key = rule.prefix;
+            else key.back() = '#';                     // walks the whole path, then misses
+            messages.push_back(key + "payload of a routed message");
+            types.push_back(hit && rule.byType ? rule.type : (i % 4 == 1 ? 60000 + i % 1000 : kRouteTypeNone));
+        }
+
+        // Block 2: compile, then match
+        static MailslotRouter router;
+        uint64_t buildNs = MailslotNowNs();
+        MailslotRouterCompile(router, table);
+        buildNs = MailslotNowNs() - buildNs;
+        uint64_t count = std::max<uint64_t>(config.count, 1000000);
+        uint64_t matched = 0;
+        uint64_t beginNs = MailslotNowNs();
+        for (uint64_t i = 0; i < count; i++) {
+            const std::string& message = messages[i & 1023];
+            uint32_t route = MailslotRouterMatch(router, types[i & 1023], message.data(), (uint32_t)message.size());
+            matched += route != router.defaultRoute;
+        }
+        double matchNs = (double)(MailslotNowNs() - beginNs) / count;
+        double matchedPct = 100.0 * matched / count;
+
+        if (config.json) {
+            char json[256];
+            snprintf(json, sizeof(json),
+                "{\"rules\":%u,\"routes\":%u,\"build_ms\":%.3f,\"ns_per_match\":%.2f,\"matched_pct\":%.1f,"
+                "\"trie_nodes\":%u}",
+                rules, (uint32_t)router.routes.size(), buildNs / 1e6, matchNs, matchedPct,
+                (uint32_t)router.nodes.size());
+            std::cout << json << std::endl;
+        } else {
+            std::cout << std::left << std::fixed << std::setw(8) << rules << std::setw(10) << router.routes.size()
+                      << std::setprecision(3) << std::setw(12) << buildNs / 1e6
+                      << std::setprecision(1) << std::setw(12) << matchNs << std::setw(12) << matchedPct
+                      << router.nodes.size() << std::endl;
+        }
+        if (rules == config.routesMax) break;
+    }
+    return 0;
+}
+
+// ------------------------------
+// Priority lanes: control latency while bulk senders keep the receiver busy
+// ------------------------------
+const uint16_t PRIORITY_TYPE_CONTROL = 1;     // frame types of the two classes
+const uint16_t PRIORITY_TYPE_BULK = 2;
+
+struct PriorityResult {
+    MailslotHistogram control;                // ns, send to handled
+    MailslotHistogram bulk;
+    uint64_t bulkSent = 0;
+    uint64_t controlSent = 0;
+    uint64_t expired = 0;                     // bulk frames dropped unhandled
+    uint64_t errors = 0;                      // failed sends
+    double seconds = 0;                       // first to last handled message
+};
+
+// Frames of one class until count are sent (count 0: every intervalNs until *stop)
+void RunPrioritySender(const BenchConfig& config, const std::string& name, uint16_t type, uint64_t count,
+                       uint64_t intervalNs, const std::atomic<bool>* stop, std::atomic<uint64_t>* sent,
+                       std::atomic<uint64_t>* errors) {
+    MailslotSender sender;
+    if (!MailslotOpenSender(sender, name)) {
+        HandleMailslotError("CreateFile");
+        errors->fetch_add(1);
+        return;
+    }
+    char frame[BENCH_MAX_MESSAGE];
+    uint32_t deadlineMs = type == PRIORITY_TYPE_BULK ? config.deadlineMs : 0;
+    uint16_t extension = MailslotFrameDeadlineSize(deadlineMs);
+    memset(MailslotFramePayload(frame, extension), 'x', config.size);
+    uint64_t localSent = 0, localErrors = 0;
+    uint64_t nextNs = MailslotNowNs();
+    for (uint32_t sequence = 0; count == 0 ? !stop->load() : sequence < count; sequence++) {
+        if (intervalNs > 0) {
+            nextNs += intervalNs;
+            while (MailslotNowNs() < nextNs) std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        uint8_t flags = MailslotFrameSetDeadline(frame, extension, deadlineMs);
+        uint32_t length = MailslotFrameSeal(frame, MailslotFrameSenderId(), sequence, config.size, type, flags, extension);
+        uint32_t bytesWritten = 0;
+        if (MailslotSend(sender, frame, length, &bytesWritten)) {
+            localSent++;
+        } else if (localErrors++ < 3) {
+            HandleMailslotError("WriteFile");
+        }
+    }
+    MailslotClose(sender);
+    sent->fetch_add(localSent);
+    errors->fetch_add(localErrors);
+}
+
+// One mode: lanes == nullptr — everything through one FIFO slot
+void RunPriorityReceiver(const BenchConfig& config, MailslotServer* server, MailslotLaneSet* lanes,
+                         const std::atomic<bool>* done, PriorityResult* result) {
+    static char buffers[MAILSLOT_BATCH_MAX][BENCH_MAX_MESSAGE];
+    MailslotMessage batch[MAILSLOT_BATCH_MAX];
+    for (uint32_t i = 0; i < MAILSLOT_BATCH_MAX; i++) {
+        batch[i].buffer = buffers[i];
+        batch[i].capacity = sizeof(buffers[i]);
+    }
+    const uint64_t workNs = (uint64_t)config.workUs * 1000;
+    uint64_t firstNs = 0, lastNs = 0;
+    while (true) {
+        uint32_t received = 0, lane = 0;
+        bool ok = lanes != nullptr ? MailslotLanesReceive(*lanes, batch, MAILSLOT_BATCH_MAX, &received, &lane, 100)
+                                   : MailslotReceiveMany(*server, batch, MAILSLOT_BATCH_MAX, &received, 100);
+        if (!ok) {
+            if (MailslotLastError() != MAILSLOT_ERROR_TIMEOUT) HandleMailslotError("ReadFile");
+            if (done->load() || MailslotLastError() != MAILSLOT_ERROR_TIMEOUT) break;
+            continue;
+        }
+        for (uint32_t i = 0; i < received; i++) {
+            MailslotFrameView frame;
+            if (MailslotFrameDecode(batch[i].buffer, batch[i].length, &frame) != MAILSLOT_FRAME_OK) continue;
+            uint64_t nowNs = MailslotNowNs();
+            if (MailslotFrameExpired(frame, nowNs)) {
+                result->expired++;
+                continue;
+            }
+            // The handler's work: latency is measured once it is done
+            while (MailslotNowNs() - nowNs < workNs) {}
+            nowNs = MailslotNowNs();
+            if (firstNs == 0) firstNs = nowNs;
+            lastNs = nowNs;
+            uint64_t latency = nowNs > frame.header->timestampNs ? nowNs - frame.header->timestampNs : 0;
+            MailslotHistogramRecord(frame.header->type == PRIORITY_TYPE_CONTROL ? result->control : result->bulk,
+                                    latency);
+        }
+    }
+    result->seconds = (double)(lastNs - firstNs) / 1e9;
+}
+
+int RunPriority(const BenchConfig& config) {
+    if (sizeof(MailslotFrameHeader) + kFrameDeadlineSize + config.size > BENCH_MAX_MESSAGE) {
+        std::cerr << "--priority needs --size <= "
+                  << BENCH_MAX_MESSAGE - sizeof(MailslotFrameHeader) - kFrameDeadlineSize << std::endl;
+        return 1;
+    }
+    if (!config.json) {
+        std::cout << "Bulk: " << config.senders << " x " << config.count << " frames of " << config.size
+                  << " bytes, deadline " << config.deadlineMs << " ms; control: 1 frame/ms; work "
+                  << config.workUs << " us/message" << std::endl;
+        std::cout << std::left << std::setw(10) << "Mode" << std::setw(26) << "control us p50/p99/max"
+                  << std::setw(12) << "bulk p99 ms" << std::setw(12) << "handled" << std::setw(10) << "expired"
+                  << std::setw(8) << "errors" << "msg/s" << std::endl;
+    }
+    const char* modes[] = { "fifo", "strict", "weighted" };
+    std::string name = MailslotLocalName(config.slot);
+    for (int mode = 0; mode < 3; mode++) {
+        // Block 1: one slot, or control / normal / bulk lanes of the same name
+        static PriorityResult result;
+        result = PriorityResult();
+        MailslotHistogramReset(result.control);
+        MailslotHistogramReset(result.bulk);
+        MailslotServer server;
+        MailslotLaneSet lanes;
+        MailslotLaneConfig laneConfig;
+        laneConfig.scheduling = mode == 2 ? MAILSLOT_LANES_WEIGHTED : MAILSLOT_LANES_STRICT;
+        bool created = mode == 0 ? MailslotCreate(server, name, BENCH_MAX_MESSAGE, 0)
+                                 : MailslotLanesCreate(lanes, name, BENCH_MAX_MESSAGE, 0, laneConfig);
+        if (!created) {
+            HandleMailslotError("CreateMailslot");
+            return 1;
+        }
+        std::string controlName = mode == 0 ? name : MailslotPriorityLaneName(name, MAILSLOT_PRIORITY_CONTROL);
+        std::string bulkName = mode == 0 ? name : MailslotPriorityLaneName(name, MAILSLOT_PRIORITY_BULK);
+
+        // Block 2: receiver, bulk senders, then the control ticker until bulk is done
+        std::atomic<bool> done{false}, bulkDone{false};
+        std::atomic<uint64_t> bulkSent{0}, controlSent{0}, errors{0};
+        std::thread receiver(RunPriorityReceiver, std::cref(config), &server, mode == 0 ? nullptr : &lanes,
+                             &done, &result);
+        std::vector<std::thread> senders;
+        for (uint32_t i = 0; i < config.senders; i++) {
+            senders.emplace_back(RunPrioritySender, std::cref(config), std::cref(bulkName), PRIORITY_TYPE_BULK,
+                                 config.count, 0, nullptr, &bulkSent, &errors);
+        }
+        std::thread control(RunPrioritySender, std::cref(config), std::cref(controlName), PRIORITY_TYPE_CONTROL,
+                            0, 1000000, &bulkDone, &controlSent, &errors);
+        for (size_t i = 0; i < senders.size(); i++) senders[i].join();
+        bulkDone.store(true);
+        control.join();
+        done.store(true);
+        receiver.join();
+        MailslotClose(server);
+        MailslotLanesClose(lanes);
+        result.bulkSent = bulkSent.load();
+        result.controlSent = controlSent.load();
+        result.errors = errors.load();
+
+        // Block 3: report
+        const MailslotHistogram& c = result.control;
+        uint64_t handled = result.control.total + result.bulk.total;
+        double rate = result.seconds > 0 ? handled / result.seconds : 0;
+        if (config.json) {
+            char json[512];
+            snprintf(json, sizeof(json),
+                "{\"mode\":\"%s\",\"control_sent\":%llu,\"control_handled\":%llu,\"control_p50_ns\":%llu,"
+                "\"control_p99_ns\":%llu,\"control_max_ns\":%llu,\"bulk_sent\":%llu,\"bulk_handled\":%llu,"
+                "\"bulk_p99_ns\":%llu,\"expired\":%llu,\"errors\":%llu,\"msg_per_s\":%.2f}",
+                modes[mode], (unsigned long long)result.controlSent, (unsigned long long)c.total,
+                (unsigned long long)MailslotHistogramPercentile(c, 50),
+                (unsigned long long)MailslotHistogramPercentile(c, 99), (unsigned long long)c.max,
+                (unsigned long long)result.bulkSent, (unsigned long long)result.bulk.total,
+                (unsigned long long)MailslotHistogramPercentile(result.bulk, 99),
+                (unsigned long long)result.expired, (unsigned long long)result.errors, rate);
+            std::cout << json << std::endl;
+        } else {
+            char controlText[64];
+            snprintf(controlText, sizeof(controlText), "%.0f / %.0f / %.0f", MailslotHistogramPercentile(c, 50) / 1e3,
+                     MailslotHistogramPercentile(c, 99) / 1e3, c.max / 1e3);
+            std::cout << std::left << std::fixed << std::setw(10) << modes[mode] << std::setw(26) << controlText
+                      << std::setprecision(2) << std::setw(12) << MailslotHistogramPercentile(result.bulk, 99) / 1e6
+                      << std::setw(12) << handled << std::setw(10) << result.expired << std::setw(8) << result.errors
+                      << std::setprecision(0) << rate << std::endl;
+        }
+    }
+    return 0;
+}
+
+// ------------------------------
+// Startup: cold vs warm receiver process, time to the first N messages
+// ------------------------------
+
+// Receiver process: the server's message path (frame check, decompression
+// into reassembly pools) from a fresh process; prints one result row
+int RunStartupChild(const BenchConfig& config, uint64_t entryNs) {
+    bool warm = config.startupChild == "warm";
+    if (warm && config.pinCpu >= 0 && !MailslotPinThread((uint32_t)config.pinCpu)) {
+        HandleMailslotError("SetThreadAffinity");
+    }
+
+    // Block 1: what every start allocates
+    MailslotServer server;
+    if (!MailslotCreate(server, MailslotLocalName(config.slot), BENCH_MAX_MESSAGE, config.timeoutMs)) {
+        HandleMailslotError("CreateMailslot");
+        return 1;
+    }
+    static MailslotReassembler reassembler;
+    MailslotReassemblerInit(reassembler, MailslotReassemblyConfig());
+    const MailslotDictionary* dictionary = &MailslotDefaultDictionary();
+    std::unique_ptr<char[]> storage(new char[(size_t)MAILSLOT_BATCH_MAX * BENCH_MAX_MESSAGE]);
+    MailslotMessage batch[MAILSLOT_BATCH_MAX];
+    for (uint32_t i = 0; i < MAILSLOT_BATCH_MAX; i++) {
+        batch[i].buffer = storage.get() + (size_t)i * BENCH_MAX_MESSAGE;
+        batch[i].capacity = BENCH_MAX_MESSAGE;
+    }
+    static MailslotHistogram latency;
+    MailslotHistogramReset(latency);
+
+    // Block 2: warm — fault everything in and run the message path once
+    if (warm) {
+        MailslotPrefault(storage.get(), (size_t)MAILSLOT_BATCH_MAX * BENCH_MAX_MESSAGE);
+        for (auto& pool : reassembler.pools) pool->Prefault();
+        char frame[BENCH_MAX_MESSAGE], raw[BENCH_MAX_MESSAGE];
+        memset(raw, 'x', config.size);
+        const uint16_t extension = sizeof(MailslotCompressionHeader);
+        uint32_t packed = MailslotCompress(dictionary, raw, config.size, MailslotFramePayload(frame, extension),
+                                           BENCH_MAX_MESSAGE - sizeof(MailslotFrameHeader) - extension);
+        uint32_t length = MailslotFrameSeal(frame, 0, 0, packed, 0, MAILSLOT_FRAME_FLAG_COMPRESSED, extension);
+        MailslotFrameView view;
+        if (packed > 0 && MailslotFrameDecode(frame, length, &view) == MAILSLOT_FRAME_OK) {
+            MailslotMessageView buffer = MailslotReassemblerBuffer(reassembler, config.size);
+            if (buffer) MailslotDecompress(dictionary, view.payload, view.payloadLength, buffer.Data(), config.size);
+        }
+    }
+
+    // Block 3: ready — the parent starts sending now
+    uint64_t readyNs = MailslotNowNs();
+    uint64_t faultsAtReady = MailslotPageFaults();
+    if (!MailslotReadyFd(config.readyFd)) {
+        HandleMailslotError("WriteReadyFd");
+        return 1;
+    }
+
+    // Block 4: handle the first N messages as the server would
+    uint64_t handled = 0, firstLatency = 0;
+    while (handled < config.startupMessages) {
+        uint32_t received = 0;
+        if (!MailslotReceiveMany(server, batch, MAILSLOT_BATCH_MAX, &received)) {
+            if (MailslotLastError() != MAILSLOT_ERROR_TIMEOUT) HandleMailslotError("ReadFile");
+            break;
+        }
+        for (uint32_t i = 0; i < received; i++) {
+            MailslotFrameView frame;
+            if (MailslotFrameDecode(batch[i].buffer, batch[i].length, &frame) != MAILSLOT_FRAME_OK) continue;
+            MailslotMessageView message;
+            if (MailslotIsCompressed(frame)) {
+                MailslotCompressionHeader info = MailslotCompressionInfo(frame);
+                message = MailslotReassemblerBuffer(reassembler, info.rawLength);
+                if (!message ||
+                    !MailslotDecompress(dictionary, frame.payload, frame.payloadLength, message.Data(), info.rawLength)) {
+                    continue;
+                }
+                message.SetLength(info.rawLength);
+            }
+            uint64_t nowNs = MailslotNowNs();
+            uint64_t value = nowNs > frame.header->timestampNs ? nowNs - frame.header->timestampNs : 0;
+            if (handled++ == 0) firstLatency = value;
+            MailslotHistogramRecord(latency, value);
+        }
+    }
+    uint64_t faults = MailslotPageFaults() - faultsAtReady;
+    MailslotClose(server);
+
+    // Block 5: report (spawn -> main -> ready, then the messages)
+    double spawnMs = (double)(entryNs - config.spawnNs) / 1e6;
+    double readyMs = (double)(readyNs - config.spawnNs) / 1e6;
+    if (config.json) {
+        char json[512];
+        snprintf(json, sizeof(json),
+            "{\"mode\":\"%s\",\"spawn_ms\":%.3f,\"ready_ms\":%.3f,\"first_ns\":%llu,\"messages\":%llu,"
+            "\"p50_ns\":%llu,\"p99_ns\":%llu,\"max_ns\":%llu,\"page_faults\":%llu}",
+            config.startupChild.c_str(), spawnMs, readyMs, (unsigned long long)firstLatency,
+            (unsigned long long)handled, (unsigned long long)MailslotHistogramPercentile(latency, 50),
+            (unsigned long long)MailslotHistogramPercentile(latency, 99), (unsigned long long)latency.max,
+            (unsigned long long)faults);
+        std::cout << json << std::endl;
+    } else {
+        std::cout << std::left << std::fixed << std::setprecision(2) << std::setw(8) << config.startupChild
+                  << std::setw(10) << spawnMs << std::setw(10) << readyMs << std::setprecision(1)
+                  << std::setw(12) << firstLatency / 1e3 << std::setw(10) << handled
+                  << std::setw(10) << MailslotHistogramPercentile(latency, 50) / 1e3
+                  << std::setw(10) << MailslotHistogramPercentile(latency, 99) / 1e3
+                  << std::setw(10) << latency.max / 1e3 << faults << std::endl;
+    }
+    return handled == config.startupMessages ? 0 : 1;
+}
+
+// Start this program as a receiver process; *readyRead gets the pipe end
+// that returns READY once the receiver is up
+bool SpawnStartupChild(const BenchConfig& config, const char* self, const std::string& mode,
+                       intptr_t* process, intptr_t* readyRead) {
+    std::vector<std::string> args = { self, "--slot", config.slot, "--size", std::to_string(config.size),
+                                      "--startup", std::to_string(config.startupMessages),
+                                      "--timeout", std::to_string(config.timeoutMs) };
+    if (config.pinCpu >= 0) args.insert(args.end(), { "--pin", std::to_string(config.pinCpu) });
+    if (config.json) args.push_back("--json");
+#ifdef _WIN32
+    SECURITY_ATTRIBUTES inherit = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+    HANDLE readEnd = NULL, writeEnd = NULL;
+    if (!CreatePipe(&readEnd, &writeEnd, &inherit, 0)) return false;
+    SetHandleInformation(readEnd, HANDLE_FLAG_INHERIT, 0);
+    char path[MAX_PATH];
+    GetModuleFileNameA(NULL, path, sizeof(path));
+    args[0] = path;
+    args.insert(args.end(), { "--startup-child", mode, std::to_string(MailslotNowNs()),
+                              std::to_string((intptr_t)writeEnd) });
+    std::string commandLine;
+    for (const std::string& arg : args) commandLine += "\"" + arg + "\" ";
+    STARTUPINFOA startup = { sizeof(STARTUPINFOA) };
+    PROCESS_INFORMATION info;
+    BOOL created = CreateProcessA(NULL, &commandLine[0], NULL, NULL, TRUE, 0, NULL, NULL, &startup, &info);
+    CloseHandle(writeEnd);
+    if (!created) {
+        CloseHandle(readEnd);
+        return false;
+    }
+    CloseHandle(info.hThread);
+    *process = (intptr_t)info.hProcess;
+    *readyRead = (intptr_t)readEnd;
+    return true;
+#else
+    int pipeFds[2];
+    if (pipe(pipeFds) != 0) return false;
+    fcntl(pipeFds[0], F_SETFD, FD_CLOEXEC);   // only the write end is inherited
+    args.insert(args.end(), { "--startup-child", mode, std::to_string(MailslotNowNs()),
+                              std::to_string(pipeFds[1]) });
+    std::vector<char*> argv;
+    for (std::string& arg : args) argv.push_back(&arg[0]);
+    argv.push_back(nullptr);
+    pid_t pid = 0;
+    int error = posix_spawn(&pid, "/proc/self/exe", NULL, NULL, argv.data(), environ);
+    close(pipeFds[1]);
+    if (error != 0) {
+        close(pipeFds[0]);
+        errno = error;
+        return false;
+    }
+    *process = pid;
+    *readyRead = pipeFds[0];
+    return true;
+#endif
+}
+
+// Block until the receiver reports READY (false — it exited first)
+bool WaitStartupReady(intptr_t readyRead) {
+    char text[16] = {0};
+#ifdef _WIN32
+    DWORD got = 0;
+    bool ok = ReadFile((HANDLE)readyRead, text, sizeof(text) - 1, &got, NULL) && got > 0;
+    CloseHandle((HANDLE)readyRead);
+#else
+    ssize_t got;
+    while ((got = read((int)readyRead, text, sizeof(text) - 1)) < 0 && errno == EINTR) {
+    }
+    bool ok = got > 0;
+    close((int)readyRead);
+#endif
+    return ok && strncmp(text, "READY=1", 7) == 0;
+}
+
+bool WaitStartupChild(intptr_t process) {
+#ifdef _WIN32
+    WaitForSingleObject((HANDLE)process, INFINITE);
+    DWORD code = 1;
+    GetExitCodeProcess((HANDLE)process, &code);
+    CloseHandle((HANDLE)process);
+    return code == 0;
+#else
+    int status = 0;
+    while (waitpid((pid_t)process, &status, 0) < 0 && errno == EINTR) {
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
+
+int RunStartup(const BenchConfig& config, const char* self) {
+    if (sizeof(MailslotFrameHeader) + sizeof(MailslotCompressionHeader) + config.size > BENCH_MAX_MESSAGE) {
+        std::cerr << "--startup needs --size <= "
+                  << BENCH_MAX_MESSAGE - sizeof(MailslotFrameHeader) - sizeof(MailslotCompressionHeader) << std::endl;
+        return 1;
+    }
+    if (!config.json) {
+        std::cout << "Receiver processes: cold and warm, " << config.startupMessages << " messages of "
+                  << config.size << " bytes each" << std::endl;
+        std::cout << std::left << std::setw(8) << "Mode" << std::setw(10) << "spawn ms" << std::setw(10)
+                  << "ready ms" << std::setw(12) << "first us" << std::setw(10) << "messages" << std::setw(10)
+                  << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "max us" << "page faults" << std::endl;
+    }
+    const uint64_t intervalNs = config.rate > 0 ? (uint64_t)(1e9 / config.rate) : 100000;
+    std::string payload(config.size, 'x');
+    bool clean = true;
+    for (int run = 0; run < 6; run++) {
+        // Block 1: start the receiver, wait until it says it is ready
+        std::string mode = run % 2 == 0 ? "cold" : "warm";
+        intptr_t process = 0, readyRead = 0;
+        std::cout.flush();
+        if (!SpawnStartupChild(config, self, mode, &process, &readyRead)) {
+            HandleMailslotError("CreateProcess");
+            return 1;
+        }
+        if (!WaitStartupReady(readyRead)) {
+            std::cerr << "Receiver exited before it was ready" << std::endl;
+            WaitStartupChild(process);
+            return 1;
+        }
+
+        // Block 2: N compressed frames, paced (the receiver prints the row)
+        MailslotSender sender;
+        if (MailslotOpenSender(sender, MailslotLocalName(config.slot))) {
+            MailslotBatchSender batch;
+            MailslotBatchInit(batch, sender, 1, BENCH_MAX_MESSAGE, false);
+            static MailslotFragmentWriter writer;
+            MailslotFragmentWriterInit(writer, BENCH_MAX_MESSAGE);
+            MailslotCompressor compressor;
+            MailslotCompressorInit(compressor, &MailslotDefaultDictionary());
+            uint64_t nextNs = MailslotNowNs();
+            for (uint32_t i = 0; i < config.startupMessages; i++) {
+                while (MailslotNowNs() < nextNs) {}
+                nextNs += intervalNs;
+                MailslotCompressedSend(compressor, writer, batch, payload.data(), (uint32_t)payload.size());
+            }
+            MailslotClose(sender);
+        } else {
+            HandleMailslotError("CreateFile");
+        }
+        if (!WaitStartupChild(process)) clean = false;
+    }
+    return clean ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t entryNs = MailslotNowNs();       // --startup-child: process start
+    MailslotInitConsole();                    // Console code page
+
+    BenchConfig config;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--role" && hasValue)             config.role = argv[++i];
+        else if (arg == "--slot" && hasValue)        config.slot = argv[++i];
+        else if (arg == "--shm")                     config.mode = MAILSLOT_MODE_SHARED_MEMORY;
+        else if (arg == "--size" && hasValue)        config.size = (uint32_t)atoi(argv[++i]);
+        else if (arg == "--count" && hasValue)       config.count = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--senders" && hasValue)     config.senders = (uint32_t)atoi(argv[++i]);
+        else if (arg == "--rate" && hasValue)        config.rate = atof(argv[++i]);
+        else if (arg == "--closed-loop" && hasValue) config.window = (uint32_t)atoi(argv[++i]);
+        else if (arg == "--timeout" && hasValue)     config.timeoutMs = (uint32_t)atoi(argv[++i]);
+        else if (arg == "--scale") {
+            config.scaleMax = 64;
+            if (hasValue && argv[i + 1][0] != '-') config.scaleMax = (uint32_t)atoi(argv[++i]);
+        }
+        else if (arg == "--routes") {
+            config.routesMax = 1000;
+            if (hasValue && argv[i + 1][0] != '-') config.routesMax = (uint32_t)atoi(argv[++i]);
+        }
+        else if (arg == "--priority")                config.priority = true;
+        else if (arg == "--work-us" && hasValue)     config.workUs = (uint32_t)atoi(argv[++i]);
+        else if (arg == "--deadline-ms" && hasValue) config.deadlineMs = (uint32_t)atoi(argv[++i]);
+        else if (arg == "--pin" && hasValue)         config.pinCpu = atoi(argv[++i]);
+        else if (arg == "--startup") {
+            config.startupMessages = 1000;
+            if (hasValue && argv[i + 1][0] != '-') config.startupMessages = (uint32_t)atoi(argv[++i]);
+        }
+        else if (arg == "--startup-child" && i + 3 < argc) {
+            config.startupChild = argv[++i];
+            config.spawnNs = strtoull(argv[++i], NULL, 10);
+            config.readyFd = (intptr_t)strtoll(argv[++i], NULL, 10);
+        }
+        else if (arg == "--json")                    config.json = true;
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (config.size < sizeof(BenchHeader) || config.size > BENCH_MAX_MESSAGE || config.senders == 0 ||
+        config.count == 0 ||
+        (config.role != "both" && config.role != "server" && config.role != "client") ||
+        ((config.window > 0 || config.scaleMax > 0) && config.role != "both")) {
+        std::cerr << "Invalid configuration (size 24..300, senders >= 1, count >= 1, "
+                     "closed loop and scaling need --role both)" << std::endl;
+        return 1;
+    }
+    if (config.scaleMax > 64) {
+        std::cerr << "--scale MAX must be 1..64" << std::endl;
+        return 1;
+    }
+    if (config.routesMax > 0) return RunRoutes(config);
+    if (config.priority) return RunPriority(config);
+    if (!config.startupChild.empty()) return RunStartupChild(config, entryNs);
+    if (config.startupMessages > 0) return RunStartup(config, argv[0]);
+    if (config.scaleMax > 0) return RunScale(config);
+
+    static BenchResult result;                // large histogram: keep it off the stack
+    if (!RunBench(config, &result)) return 1;
+    if (config.json) {
+        PrintJson(config, result);
+    } else {
+        PrintText(config, result);
+    }
+    return (result.sendErrors == 0 && result.lost == 0) ? 0 : 1;
+}
@@ -1,131 +1,170 @@
-#include <windows.h>
+#include "MailslotBroadcast.h"
+#include "MailslotSenderCache.h"
+#include "MailslotTransport.h"
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 // ------------------------------
 // ClientMS: simple Mailslot client
 // Opens the server mailslot (as a file) and writes a message to it.
-// Supports local and remote servers and multi-target broadcast.
+// Supports local and remote servers and multi-target broadcast: all
+// targets are sent to in parallel (see MailslotBroadcast.h), each with its
+// own deadline, and the results are printed per target.
+// Slots stay open between rounds (see MailslotSenderCache.h); a server
+// restart is picked up by a transparent reopen.
+// Usage: ClientMS [HOST...] [--deadline-ms MS] [--threads N] [--count N] [--interval-ms MS]
+//   HOST            target machine (default: local server); repeat for broadcast
+//   --deadline-ms   give up on a target after MS (default 2000)
+//   --threads N     parallel sends (default 16)
+//   --count N       broadcast rounds (default 1)
+//   --interval-ms   pause between rounds (default 0)
 // ------------------------------
 
-// Unified error printing for Mailslot/file operations
-void HandleMailslotError(const char* operation) {
-    DWORD error = GetLastError();
-    std::cerr << "Error in operation '" << operation << "': ";
-    switch (error) {
-        case ERROR_INVALID_PARAMETER:  std::cerr << "Invalid parameter"; break;
-        case ERROR_FILE_NOT_FOUND:     std::cerr << "Mailslot not found"; break;
-        case ERROR_PATH_NOT_FOUND:     std::cerr << "Path not found"; break;
-        case ERROR_PIPE_BUSY:          std::cerr << "Mailslot is busy"; break;
-        case ERROR_BROKEN_PIPE:        std::cerr << "Broken pipe"; break;
-        case ERROR_TIMEOUT:            std::cerr << "Timeout"; break;
-        case ERROR_INSUFFICIENT_BUFFER:std::cerr << "Insufficient buffer"; break;
-        default:                       std::cerr << "Error code: " << error; break;
-    }
-    std::cerr << std::endl;
-}
-
-// Utility: ANSI (Windows-1251) -> UTF‑16
-// Required to build a proper wide-string for CreateFileW
-static std::wstring to_wstring_from_ansi(const std::string &s) {
-    if (s.empty()) return std::wstring();
-    int len = MultiByteToWideChar(1251, 0, s.c_str(), (int)s.size(), NULL, 0); // compute length
-    std::wstring ws; ws.resize(len);
-    MultiByteToWideChar(1251, 0, s.c_str(), (int)s.size(), &ws[0], len);       // convert
-    return ws;
-}
-
 // Send a single message to a specific server mailslot
-// mailslotName — full path like \\.\mailslot\Box or \\HOST\mailslot\Box (wide)
+// mailslotName — full path like \\.\mailslot\Box or \\HOST\mailslot\Box
 // message      — pointer to payload bytes (server just receives bytes)
-bool SendMessageToServer(const std::wstring& mailslotName, const char* message) {
-    // CreateFileW opens the server mailslot for writing
-    // Parameters:
-    // 1) lpFileName   = mailslotName.c_str() — full mailslot path (LPCWSTR)
-    // 2) dwDesiredAccess = GENERIC_WRITE — write-only access
-    // 3) dwShareMode  = FILE_SHARE_READ — allow shared read
-    // 4) lpSecurity   = NULL — default security
-    // 5) dwCreationDisposition = OPEN_EXISTING — mailslot must already exist
-    // 6) dwFlagsAndAttributes = 0 — no special flags
-    // 7) hTemplateFile = NULL — not used
-    HANDLE hMailslot = CreateFile(
-        mailslotName.c_str(),
-        GENERIC_WRITE,
-        FILE_SHARE_READ,
-        NULL,
-        OPEN_EXISTING,
-        0,
-        NULL
-    );
-    
-    if (hMailslot == INVALID_HANDLE_VALUE) {       // If server is not running — ERROR_FILE_NOT_FOUND
-        HandleMailslotError("CreateFile");
-        std::cerr << "Failed to open Mailslot" << std::endl;
-        return false;
-    }
-    
-    // Write payload
-    DWORD bytesWritten = 0;
-    BOOL writeResult = WriteFile(
-        hMailslot,                             // mailslot handle
+// cache        — open senders shared by all rounds
+// operation    — on failure, the step that failed (error in MailslotLastError)
+// Runs on a broadcast worker thread, so it does not print.
+bool SendMessageToServer(MailslotSenderCache& cache, const std::string& mailslotName, const char* message,
+                         const char** operation) {
+    // The cache opens the server mailslot on first use (CreateFile with
+    // GENERIC_WRITE / OPEN_EXISTING on Windows) and keeps it open; a stale
+    // handle is reopened once. Fails with MAILSLOT_ERROR_NOT_FOUND when the
+    // server is not running.
+    uint32_t bytesWritten = 0;
+    return MailslotCachedSend(
+        cache,                                 // open senders
+        mailslotName,                          // slot path (cache key)
         message,                               // data pointer
-        (DWORD)strlen(message),                // data length (bytes)
+        (uint32_t)strlen(message),             // data length (bytes)
         &bytesWritten,                         // actually written
-        NULL                                   // synchronous I/O
+        operation                              // failed step
     );
-    
-    if (writeResult == FALSE) {                 // Write error
-        HandleMailslotError("WriteFile");
-        CloseHandle(hMailslot);
-        return false;
-    }
-    
-    CloseHandle(hMailslot);                     // Release handle
-    std::cout << "Message sent (" << bytesWritten << " bytes): " << message << std::endl;
-    return true;
 }
 
+// Per-target totals over all rounds
+struct TargetReport {
+    int sent = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+    const char* operation = "";           // last failure
+    MailslotErrorCode error = 0;
+};
+
 int main(int argc, char* argv[]) {
-    SetConsoleCP(1251);                         // Console input in 1251
-    SetConsoleOutputCP(1251);                   // Console output in 1251
+    MailslotInitConsole();                      // Console code page: Windows-1251
 
     // Build target list. Supported forms:
     // - no args: local server \\.\mailslot\Box
     // - one/more args: machine names for \\HOST\mailslot\Box
     const char* message = "Hello from Maislot-client"; // Payload string
-    std::vector<std::wstring> servers;                  // Targets
+    std::vector<MailslotBroadcastTarget> servers;       // Targets
+    MailslotBroadcastConfig config;                     // Threads and default deadline
+    int rounds = 1;                                     // Broadcast rounds
+    uint32_t intervalMs = 0;                            // Pause between rounds
     
-    if (argc > 1) {
-        // Arguments present: each becomes a separate target
-        for (int i = 1; i < argc; i++) {
-            std::string computerNameA = argv[i];        // Host in ANSI
-            if (computerNameA == "." || computerNameA == "localhost") {
-                servers.push_back(L"\\\\.\\mailslot\\Box"); // Local format
+    // Arguments: each host becomes a separate target
+    // ("." and "localhost" map to the local format)
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--deadline-ms" && i + 1 < argc) {
+            config.deadlineMs = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            config.threads = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--count" && i + 1 < argc) {
+            rounds = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--interval-ms" && i + 1 < argc) {
+            intervalMs = (uint32_t)atoi(argv[++i]);
+        } else {
+            MailslotBroadcastTarget target;
+            target.name = MailslotRemoteName(arg, "Box");
+            servers.push_back(target);
+        }
+    }
+    if (servers.empty()) {
+        // No hosts — use local server
+        MailslotBroadcastTarget target;
+        target.name = MailslotLocalName("Box");
+        servers.push_back(target);
+    }
+    
+    // Open slots are reused by every round (LRU-bounded). The send function
+    // shares ownership, so a worker abandoned at its deadline can still
+    // finish through it; a target it is stuck on is skipped in later rounds.
+    std::shared_ptr<MailslotSenderCache> cacheOwner = std::make_shared<MailslotSenderCache>();
+    MailslotSenderCache& cache = *cacheOwner;
+    MailslotSenderCacheInit(cache, MailslotSenderCacheConfig());
+    std::shared_ptr<MailslotBroadcastInFlight> inFlight = std::make_shared<MailslotBroadcastInFlight>();
+    
+    // Send to all servers at once; each round waits for the slowest (or its deadline)
+    std::cout << "Sending to " << servers.size() << " server(s)";
+    if (rounds > 1) std::cout << ", " << rounds << " rounds";
+    std::cout << "..." << std::endl;
+    std::vector<TargetReport> reports(servers.size());
+    std::vector<MailslotBroadcastResult> results;
+    double elapsedMs = 0, slowestMs = 0, sumMs = 0;
+    for (int round = 0; round < rounds; round++) {
+        if (round > 0 && intervalMs > 0) std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        uint64_t startNs = MailslotNowNs();
+        MailslotBroadcast(servers, config,
+            [cacheOwner, message](const std::string& name, const char** operation) {
+                return SendMessageToServer(*cacheOwner, name, message, operation);
+            },
+            &results, inFlight);
+        elapsedMs += (double)(MailslotNowNs() - startNs) / 1e6;
+        for (size_t i = 0; i < results.size(); i++) {
+            TargetReport& report = reports[i];
+            report.totalNs += results[i].latencyNs;
+            report.maxNs = std::max(report.maxNs, results[i].latencyNs);
+            slowestMs = std::max(slowestMs, (double)results[i].latencyNs / 1e6);
+            sumMs += (double)results[i].latencyNs / 1e6;
+            if (results[i].ok) {
+                report.sent++;
             } else {
-                std::wstring computerName = to_wstring_from_ansi(computerNameA); // Convert name
-                servers.push_back(L"\\\\" + computerName + L"\\mailslot\\Box"); // Remote format
+                report.operation = results[i].operation;
+                report.error = results[i].error;
             }
         }
-    } else {
-        // No args — use local server
-        servers.push_back(L"\\\\.\\mailslot\\Box");
     }
     
-    // Send to one or multiple servers
+    // Per-target report
     int successCount = 0;
-    for (size_t i = 0; i < servers.size(); i++) {
-        std::wcout << L"[" << (i + 1) << L"] Sending attempt" << std::endl; // Wide log line
-        if (SendMessageToServer(servers[i], message)) {
+    std::cout << std::fixed << std::setprecision(2);
+    for (size_t i = 0; i < reports.size(); i++) {
+        const TargetReport& report = reports[i];
+        double averageMs = (double)report.totalNs / rounds / 1e6;
+        std::cout << "[" << (i + 1) << "] " << servers[i].name << ": ";
+        if (report.sent == rounds) {
             successCount++;
-        } else {
-            std::wcout << L"Failed to send" << std::endl;
-            std::cout << "Make sure ServerMS is running." << std::endl;
+            std::cout << "sent (" << strlen(message) << " bytes)";
+            if (rounds > 1) std::cout << " x" << rounds << ", avg " << averageMs << " ms, max "
+                                      << (double)report.maxNs / 1e6 << " ms" << std::endl;
+            else std::cout << " in " << averageMs << " ms" << std::endl;
+            continue;
         }
+        const char* text = MailslotErrorText(report.error);
+        if (rounds > 1) std::cout << "sent " << report.sent << " of " << rounds << ", last ";
+        std::cout << "FAILED in " << report.operation << " after " << (rounds > 1 ? (double)report.maxNs / 1e6 : averageMs)
+                  << " ms: ";
+        if (text != NULL) std::cout << text;
+        else std::cout << "Error code: " << report.error;
+        std::cout << " (" << report.error << ")" << std::endl;
     }
+    if (successCount < (int)reports.size()) std::cout << "Make sure ServerMS is running on every target." << std::endl;
     
     std::cout << "\nResult: sent successfully to " << successCount << " of " << servers.size() << " server(s)" << std::endl;
+    std::cout << "Broadcast time: " << elapsedMs << " ms (slowest target " << slowestMs
+              << " ms, sequential estimate " << sumMs << " ms)" << std::endl;
+    if (rounds > 1) {
+        std::cout << "Sender cache: " << cache.opens.load() << " opens, " << cache.hits.load() << " reuses, "
+                  << cache.reopens.load() << " reopens, " << cache.backoffs.load() << " refused during backoff"
+                  << std::endl;
+    }
     std::cout << "Client is exiting." << std::endl;
-    return (successCount == servers.size()) ? 0 : 1;    // Exit code: 0 — all OK, 1 — partial/failed
+    return (successCount == (int)servers.size()) ? 0 : 1; // Exit code: 0 — all OK, 1 — partial/failed
 }
-
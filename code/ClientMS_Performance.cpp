@@ -1,4 +1,12 @@
-#include <windows.h>
+#include "MailslotBatch.h"
+#include "MailslotCompress.h"
+#include "MailslotFragment.h"
+#include "MailslotPriority.h"
+#include "MailslotSenderCache.h"
+#include "MailslotTransport.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <iomanip>
@@ -6,124 +14,441 @@
 // ------------------------------
 // ClientMS_Performance: sends 1000 messages to the server Mailslot
 // Measures elapsed time, messages/sec and throughput.
+// Usage: ClientMS_Performance [HOST] [--shm] [--count N] [--batch N]
+//                             [--coalesce] [--flush-us N] [--sweep] [--framed]
+//                             [--size BYTES] [--large] [--compare-open] [--flow]
+//                             [--compress [--dictionary FILE|none]] [--compare-compress]
+//                             [--priority control|normal|bulk] [--deadline-ms N]
+//   --shm       write into the server's shared-memory ring (local server only)
+//   --count N   messages per run (default 1000)
+//   --batch N   datagrams per batched send (default 1 — one write per message)
+//   --coalesce  pack several messages into one datagram (up to 300 bytes)
+//   --flush-us  flush a partial batch after N microseconds
+//   --sweep     run batch sizes 1/8/64/256 and print a comparison table
+//   --framed    send binary frames (see MailslotFrame.h): process id as the
+//               sender id, one sequence number per message, CRC32C
+//   --size N    payload size in bytes; above 300 bytes messages are framed
+//               and split into fragments (see MailslotFragment.h)
+//   --large     run 4 KB / 64 KB / 1 MB payloads (32 MB each) and print a
+//               throughput table
+//   --compare-open  send one message per write through a cached sender and
+//               with open + write + close per message, and compare
+//   --flow      credit-based flow control: wait for the server's credits
+//               before each write (server started with --credits N)
+//   --compress  compress every message (see MailslotCompress.h) with the
+//               built-in dictionary, or one trained from --dictionary FILE
+//               (one sample payload per line; the server needs the same file)
+//   --compare-compress  send the same messages framed and compressed, and
+//               compare datagrams, payload throughput and CPU time
+//   --priority  send to the lane of that class (server started with
+//               --priority, see MailslotPriority.h; default normal — Box)
+//   --deadline-ms N  framed messages the server has not processed N ms
+//               after they were sent are dropped unhandled
 // ------------------------------
 
-// Unified error printing
-void HandleMailslotError(const char* operation) {
-    DWORD error = GetLastError();
-    std::cerr << "Error in operation '" << operation << "': ";
-    switch (error) {
-        case ERROR_INVALID_PARAMETER:  std::cerr << "Invalid parameter"; break;
-        case ERROR_FILE_NOT_FOUND:     std::cerr << "Mailslot not found"; break;
-        case ERROR_PATH_NOT_FOUND:     std::cerr << "Path not found"; break;
-        case ERROR_PIPE_BUSY:          std::cerr << "Mailslot is busy"; break;
-        case ERROR_BROKEN_PIPE:        std::cerr << "Broken pipe"; break;
-        case ERROR_TIMEOUT:            std::cerr << "Timeout"; break;
-        case ERROR_INSUFFICIENT_BUFFER:std::cerr << "Insufficient buffer"; break;
-        default:                       std::cerr << "Error code: " << error; break;
-    }
-    std::cerr << std::endl;
-}
+const uint32_t MAX_FRAME_SIZE = 300;          // ServerMS_MultiMessage nMaxMessage
+uint32_t messageDeadlineMs = 0;               // --deadline-ms (0 — messages never expire)
+std::string creditSlotName;                   // --flow: the server's credit channel (the base slot;
+                                              // priority lanes share it)
 
-int main(int argc, char* argv[]) {
-    SetConsoleCP(1251);                       // Console input in 1251
-    SetConsoleOutputCP(1251);                 // Console output in 1251
+// Result of one send run
+struct SendResult {
+    int successCount = 0;                     // Messages delivered
+    int errorCount = 0;                       // Messages lost to failed writes
+    uint64_t datagrams = 0;                   // Datagrams actually written
+    uint64_t fragments = 0;                   // Fragment frames of large messages
+    uint64_t flowWaits = 0;                   // Writes that waited for credits
+    double flowWaitSeconds = 0;               // Time spent waiting for credits
+    uint64_t flowStalls = 0;                  // Waits that gave up (server stalled)
+    uint64_t compressed = 0;                  // Messages sent compressed
+    uint64_t rawBytes = 0;                    // Payload bytes before compression
+    uint64_t wireBytes = 0;                   // Payload bytes after compression
+    double compressSeconds = 0;               // Time spent compressing
+    double elapsedSeconds = 0;                // Wall time of the send loop
+    double cpuSeconds = 0;                    // Process CPU time of the send loop
+};
 
-    const int MESSAGE_COUNT = 1000;           // How many messages to send
-    const char* message = "Hello from Maislot-client"; // Payload
-    size_t messageLen = strlen(message);      // Payload size in bytes
-    
-    // Local lambda: ANSI (1251) -> UTF‑16
-    auto to_wstring_from_ansi = [](const std::string &s) -> std::wstring {
-        if (s.empty()) return std::wstring();
-        int len = MultiByteToWideChar(1251, 0, s.c_str(), (int)s.size(), NULL, 0);
-        std::wstring ws; ws.resize(len);
-        MultiByteToWideChar(1251, 0, s.c_str(), (int)s.size(), &ws[0], len);
-        return ws;
-    };
-
-    // Default target: local \\.\mailslot\Box
-    std::wstring mailslotNameW = L"\\\\.\\mailslot\\Box";
-    // If an argument is provided, treat it as a remote machine name
-    if (argc > 1) {
-        std::string computerNameA = argv[1];
-        std::wstring computerName = to_wstring_from_ansi(computerNameA);
-        mailslotNameW = L"\\\\" + computerName + L"\\mailslot\\Box";
-    }
-    
-    std::cout << "Performance test: sending " << MESSAGE_COUNT << " messages" << std::endl;
-    std::wcout << L"Server: " << mailslotNameW << std::endl;
-    std::cout << "Message size: " << messageLen << " bytes" << std::endl;
-    
+// Send messageCount copies of message through a batch sender
+bool RunSendTest(const std::string& mailslotName, MailslotMode mode, const std::string& message, int messageCount,
+                 uint32_t batchSize, bool coalesce, uint32_t flushUs, bool framed, bool flow,
+                 MailslotCompressor* compressor, bool progress, SendResult* result) {
     // Open server mailslot once
-    HANDLE hMailslot = CreateFile(
-        mailslotNameW.c_str(),   // LPCWSTR name
-        GENERIC_WRITE,           // write access
-        FILE_SHARE_READ,         // allow shared read
-        NULL,                    // default security
-        OPEN_EXISTING,           // mailslot must exist
-        0,                       // flags/attributes
-        NULL                     // template not used
-    );
-    if (hMailslot == INVALID_HANDLE_VALUE) {
+    MailslotSender sender;
+    if (!MailslotOpenSender(sender, mailslotName, mode)) {
         HandleMailslotError("CreateFile");
         std::cout << "Failed to open Mailslot" << std::endl;
         std::cout << "Make sure ServerMS is running." << std::endl;
-        return 1;
+        return false;
     }
-    std::cout << "Mailslot opened. Starting to send..." << std::endl;
+    if (progress) std::cout << "Mailslot opened. Starting to send..." << std::endl;
+
+    MailslotBatchSender batch;
+    MailslotBatchInit(batch, sender, batchSize, MAX_FRAME_SIZE, coalesce, std::chrono::microseconds(flushUs));
+    uint32_t messageLen = (uint32_t)message.size();
+    // A lost fragment loses the whole message: wait for ring space instead
+    batch.waitWhenBusy = messageLen > MAX_FRAME_SIZE;
+
+    // Flow control: writes wait for credits published by the server
+    MailslotCreditChannel credit;
+    if (flow) {
+        if (MailslotCreditOpen(credit, creditSlotName.empty() ? mailslotName : creditSlotName)) {
+            batch.credit = &credit;
+            if (progress) std::cout << "Flow control: " << MailslotCreditWindow(credit) << " credits" << std::endl;
+        } else {
+            std::cout << "Flow control unavailable (start the server with --credits N); sending without it"
+                      << std::endl;
+        }
+    }
+    int reportedErrors = 0;
+
+    // Framed: one writer per process, so sequence numbers continue across runs
+    static MailslotFragmentWriter writer;
+    if (writer.scratch.empty()) MailslotFragmentWriterInit(writer, MAX_FRAME_SIZE);
+    writer.deadlineMs = messageDeadlineMs;
+    uint64_t fragmentsBefore = writer.fragments;
+    MailslotCompressor before;
+    if (compressor != nullptr) before = *compressor;
     
-    // High-resolution timers
-    LARGE_INTEGER frequency, startTime, endTime;
-    QueryPerformanceFrequency(&frequency);     // ticks per second
-    QueryPerformanceCounter(&startTime);       // start
+    // High-resolution timer (QueryPerformanceCounter on Windows)
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point startTime = Clock::now(); // start
+    uint64_t startCpuNs = MailslotProcessCpuNs();
     
-    int successCount = 0;                      // Successfully sent
-    int errorCount = 0;                        // Failed writes
+    for (int i = 0; i < messageCount; i++) {
+        bool added = compressor != nullptr
+            ? MailslotCompressedSend(*compressor, writer, batch, message.data(), messageLen)
+            : framed
+            ? MailslotFragmentSend(writer, batch, message.data(), messageLen)
+            : MailslotBatchAdd(batch, message.data(), messageLen);
+        if (!added && reportedErrors++ < 5) {
+            HandleMailslotError("WriteFile");   // avoid spamming the console
+        }
+        if (progress && (i + 1) % 100 == 0) {   // progress every 100 messages
+            std::cout << "Sent: " << (i + 1) << " / " << messageCount << std::endl;
+        }
+    }
+    if (!MailslotBatchFlush(batch) && reportedErrors++ < 5) {
+        HandleMailslotError("WriteFile");
+    }
+    
+    Clock::time_point endTime = Clock::now();  // end
+    result->cpuSeconds = (double)(MailslotProcessCpuNs() - startCpuNs) / 1e9;
+    MailslotClose(sender);
+    if (batch.credit != nullptr) {
+        result->flowWaits = credit.waits;
+        result->flowWaitSeconds = (double)credit.waitNs / 1e9;
+        result->flowStalls = credit.stalls;
+        MailslotCreditClose(credit);
+    }
+
+    result->fragments = writer.fragments - fragmentsBefore;
+    if (compressor != nullptr) {
+        result->compressed = compressor->compressed - before.compressed;
+        result->rawBytes = compressor->rawBytes - before.rawBytes;
+        result->wireBytes = compressor->wireBytes - before.wireBytes;
+        result->compressSeconds = (double)(compressor->compressNs - before.compressNs) / 1e9;
+    }
+    if (result->fragments > 0) {
+        // Batch counters are per fragment: each failed one loses (at most) one message
+        result->errorCount = (int)std::min<uint64_t>((uint64_t)messageCount, batch.errors);
+        result->successCount = messageCount - result->errorCount;
+    } else {
+        result->successCount = (int)batch.messagesSent;
+        result->errorCount = messageCount - (int)batch.messagesSent;
+    }
+    result->datagrams = batch.datagramsSent;
+    result->elapsedSeconds = std::chrono::duration<double>(endTime - startTime).count(); // t
+    return true;
+}
+
+// One message per write: through the sender cache (open once) or with an
+// open + write + close per message, as ClientMS used to do
+bool RunOpenTest(const std::string& mailslotName, MailslotMode mode, const std::string& message, int messageCount,
+                 bool cached, SendResult* result) {
+    MailslotSenderCacheConfig config;
+    config.mode = mode;
+    MailslotSenderCache cache;
+    MailslotSenderCacheInit(cache, config);
+    uint32_t messageLen = (uint32_t)message.size();
+    int reportedErrors = 0;
+    result->successCount = 0;
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point startTime = Clock::now();
+    for (int i = 0; i < messageCount; i++) {
+        uint32_t bytesWritten = 0;
+        const char* operation = "WriteFile";
+        bool ok = false;
+        if (cached) {
+            ok = MailslotCachedSend(cache, mailslotName, message.data(), messageLen, &bytesWritten, &operation);
+        } else {
+            MailslotSender sender;
+            operation = "CreateFile";
+            if (MailslotOpenSender(sender, mailslotName, mode)) {
+                operation = "WriteFile";
+                ok = MailslotSend(sender, message.data(), messageLen, &bytesWritten);
+                MailslotClose(sender);
+            }
+        }
+        if (ok) result->successCount++;
+        else if (reportedErrors++ < 5) HandleMailslotError(operation);
+    }
+    Clock::time_point endTime = Clock::now();
+
+    result->errorCount = messageCount - result->successCount;
+    result->datagrams = (uint64_t)result->successCount;
+    result->elapsedSeconds = std::chrono::duration<double>(endTime - startTime).count();
+    return true;
+}
+
+// size bytes of readable text for large-message runs
+std::string MakePayload(const char* text, size_t size) {
+    std::string payload;
+    payload.reserve(size);
+    while (payload.size() < size) {
+        payload.append(text, std::min(strlen(text), size - payload.size()));
+        if (payload.size() < size) payload += ' ';
+    }
+    return payload;
+}
+
+int main(int argc, char* argv[]) {
+    MailslotInitConsole();                    // Console code page: Windows-1251
+
+    int messageCount = 1000;                  // How many messages to send
+    const char* text = "Hello from Maislot-client"; // Payload
+    std::string message = text;
+    bool large = false;                       // 4 KB / 64 KB / 1 MB comparison
+    uint32_t batchSize = 1;                   // Datagrams per batched send
+    uint32_t flushUs = 0;                     // Partial batch deadline
+    bool coalesce = false;                    // Coalesced frames
+    bool sweep = false;                       // Batch size comparison
+    bool compareOpen = false;                 // Cached sender vs open per message
+    bool flow = false;                        // Credit-based flow control
+    bool framed = false;                      // Binary frames with sequence numbers
+    bool compress = false;                    // Compressed frames
+    bool compareCompress = false;             // Framed vs compressed
+    std::string dictionaryFile;               // empty — built-in dictionary
+    MailslotPriority priority = MAILSLOT_PRIORITY_NORMAL;  // Lane on the server
     
-    for (int i = 0; i < MESSAGE_COUNT; i++) {
-        DWORD bytesWritten = 0;
-        BOOL writeResult = WriteFile(
-            hMailslot,               // mailslot handle
-            message,                 // data
-            (DWORD)messageLen,       // size
-            &bytesWritten,           // actually written
-            NULL                     // synchronous I/O
-        );
-        if (writeResult == FALSE) {
-            errorCount++;
-            if (errorCount <= 5) {   // avoid spamming the console
-                HandleMailslotError("WriteFile");
+    // Default target: local \\.\mailslot\Box
+    std::string mailslotName = MailslotLocalName("Box");
+    MailslotMode mode = MAILSLOT_MODE_KERNEL;
+    // Options; any other argument is treated as a remote machine name
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--shm") {
+            mode = MAILSLOT_MODE_SHARED_MEMORY;
+        } else if (arg == "--count" && i + 1 < argc) {
+            messageCount = atoi(argv[++i]);
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batchSize = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--flush-us" && i + 1 < argc) {
+            flushUs = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--coalesce") {
+            coalesce = true;
+        } else if (arg == "--sweep") {
+            sweep = true;
+        } else if (arg == "--compare-open") {
+            compareOpen = true;
+        } else if (arg == "--flow") {
+            flow = true;
+        } else if (arg == "--framed") {
+            framed = true;
+        } else if (arg == "--size" && i + 1 < argc) {
+            message = MakePayload(text, strtoul(argv[++i], NULL, 10));
+        } else if (arg == "--large") {
+            large = true;
+        } else if (arg == "--compress") {
+            compress = true;
+        } else if (arg == "--compare-compress") {
+            compareCompress = true;
+        } else if (arg == "--dictionary" && i + 1 < argc) {
+            dictionaryFile = argv[++i];
+        } else if (arg == "--priority" && i + 1 < argc) {
+            if (!MailslotPriorityParse(argv[++i], &priority)) {
+                std::cout << "Unknown priority: " << argv[i] << " (control, normal or bulk)" << std::endl;
+                return 1;
             }
+        } else if (arg == "--deadline-ms" && i + 1 < argc) {
+            messageDeadlineMs = (uint32_t)atoi(argv[++i]);
         } else {
-            successCount++;
+            mailslotName = MailslotRemoteName(arg, "Box");
         }
-        if ((i + 1) % 100 == 0) {    // progress every 100 messages
-            std::cout << "Sent: " << (i + 1) << " / " << MESSAGE_COUNT << std::endl;
+    }
+    
+    creditSlotName = mailslotName;
+    mailslotName = MailslotPriorityLaneName(mailslotName, priority);
+    if (message.size() > MAX_FRAME_SIZE) framed = true;   // needs fragments
+    if (messageDeadlineMs > 0) framed = true;             // the deadline travels in the frame
+    size_t messageLen = message.size();       // Payload size in bytes
+
+    // Compression dictionary (the server must use the same one)
+    MailslotDictionary trained;
+    const MailslotDictionary* dictionary = &MailslotDefaultDictionary();
+    if (dictionaryFile == "none") {
+        dictionary = nullptr;
+    } else if (!dictionaryFile.empty()) {
+        if (!MailslotDictionaryTrainFile(trained, dictionaryFile)) {
+            std::cout << "Cannot read dictionary samples: " << dictionaryFile << std::endl;
+            return 1;
+        }
+        dictionary = &trained;
+    }
+    MailslotCompressor compressor;
+    MailslotCompressorInit(compressor, dictionary);
+    MailslotCompressor* sendCompressor = compress ? &compressor : nullptr;
+
+    // Large payloads: same byte budget per size, fragments through 300-byte datagrams
+    if (large) {
+        const uint32_t sizes[] = { 4u << 10, 64u << 10, 1u << 20 };
+        const uint64_t budget = 32ull << 20;
+        std::cout << "Large message test: " << (budget >> 20) << " MB per size, batch " << batchSize << std::endl;
+        std::cout << "Server: " << mailslotName << std::endl;
+        std::cout << "\n   Size  Messages  Fragments  Errors        msg/s       MB/s" << std::endl;
+        bool allOk = true;
+        for (uint32_t size : sizes) {
+            std::string payload = MakePayload(text, size);
+            int count = (int)std::max<uint64_t>(4, budget / size);
+            SendResult result;
+            if (!RunSendTest(mailslotName, mode, payload, count, batchSize, coalesce, flushUs, true, flow, sendCompressor, false, &result)) {
+                return 1;
+            }
+            double messagesPerSecond = result.successCount / result.elapsedSeconds;
+            std::cout << std::setw(6) << (size >> 10) << "K"
+                      << std::setw(10) << count
+                      << std::setw(11) << result.fragments
+                      << std::setw(8) << result.errorCount
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(13) << messagesPerSecond
+                      << std::setw(11) << messagesPerSecond * size / (1024.0 * 1024.0) << std::endl;
+            allOk = allOk && result.errorCount == 0;
         }
+        std::cout << "\nClient is exiting." << std::endl;
+        return allOk ? 0 : 1;
+    }
+
+    std::cout << "Performance test: sending " << messageCount << " messages" << std::endl;
+    std::cout << "Server: " << mailslotName << std::endl;
+    std::cout << "Message size: " << messageLen << " bytes"
+              << (compress ? " (compressed frames)" : framed ? " (+32-byte frame header)" : "") << std::endl;
+
+    // Framed vs compressed: wire size, payload throughput and CPU cost
+    if (compareCompress) {
+        std::cout << "Dictionary: " << (dictionary != nullptr ? dictionary->data.size() : 0) << " bytes" << std::endl;
+        std::cout << "\nMode        Datagrams    B/msg  Errors        msg/s  payload MB/s  CPU us/msg  compress us/msg"
+                  << std::endl;
+        bool allOk = true;
+        for (int packed = 0; packed <= 1; packed++) {
+            SendResult result;
+            if (!RunSendTest(mailslotName, mode, message, messageCount, batchSize, coalesce, flushUs, true, flow,
+                             packed ? &compressor : nullptr, false, &result)) {
+                return 1;
+            }
+            double messagesPerSecond = result.successCount / result.elapsedSeconds;
+            double wirePerMessage = packed ? (double)result.wireBytes / messageCount : (double)messageLen;
+            std::cout << std::left << std::setw(10) << (packed ? "compressed" : "framed") << std::right
+                      << std::setw(11) << result.datagrams
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(9) << wirePerMessage
+                      << std::setw(8) << result.errorCount
+                      << std::setprecision(2)
+                      << std::setw(13) << messagesPerSecond
+                      << std::setw(14) << messagesPerSecond * messageLen / (1024.0 * 1024.0)
+                      << std::setprecision(3)
+                      << std::setw(12) << result.cpuSeconds * 1e6 / messageCount
+                      << std::setw(17) << result.compressSeconds * 1e6 / messageCount << std::endl;
+            allOk = allOk && result.errorCount == 0;
+        }
+        std::cout << "\nClient is exiting." << std::endl;
+        return allOk ? 0 : 1;
+    }
+
+    // Cached sender vs open + write + close per message
+    if (compareOpen) {
+        std::cout << "\nPath                 Errors        msg/s    us/msg" << std::endl;
+        bool allOk = true;
+        for (int cached = 1; cached >= 0; cached--) {
+            SendResult result;
+            RunOpenTest(mailslotName, mode, message, messageCount, cached != 0, &result);
+            double messagesPerSecond = result.successCount / result.elapsedSeconds;
+            std::cout << std::left << std::setw(18) << (cached ? "cached sender" : "open per message")
+                      << std::right << std::setw(9) << result.errorCount
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(13) << messagesPerSecond
+                      << std::setw(10) << result.elapsedSeconds * 1e6 / messageCount << std::endl;
+            allOk = allOk && result.errorCount == 0;
+        }
+        std::cout << "\nClient is exiting." << std::endl;
+        return allOk ? 0 : 1;
+    }
+
+    // Sweep: one run per batch size, compact table
+    if (sweep) {
+        const uint32_t batchSizes[] = { 1, 8, 64, 256 };
+        std::cout << "\nBatch    Datagrams  Errors        msg/s           B/s" << std::endl;
+        bool allOk = true;
+        for (uint32_t size : batchSizes) {
+            SendResult result;
+            if (!RunSendTest(mailslotName, mode, message, messageCount, size, coalesce, flushUs, framed, flow, sendCompressor, false, &result)) {
+                return 1;
+            }
+            double messagesPerSecond = result.successCount / result.elapsedSeconds;
+            std::cout << std::setw(5) << size
+                      << std::setw(13) << result.datagrams
+                      << std::setw(8) << result.errorCount
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(13) << messagesPerSecond
+                      << std::setw(14) << messagesPerSecond * messageLen << std::endl;
+            allOk = allOk && result.errorCount == 0;
+        }
+        std::cout << "\nClient is exiting." << std::endl;
+        return allOk ? 0 : 1;
     }
     
-    QueryPerformanceCounter(&endTime);         // end
-    CloseHandle(hMailslot);
+    SendResult result;
+    if (!RunSendTest(mailslotName, mode, message, messageCount, batchSize, coalesce, flushUs, framed, flow, sendCompressor, true, &result)) {
+        return 1;
+    }
     
     // Metrics
-    double elapsedSeconds = (double)(endTime.QuadPart - startTime.QuadPart) / frequency.QuadPart; // t = dTicks / Hz
-    double messagesPerSecond = (double)successCount / elapsedSeconds;                              // msg/s
-    double totalBytes = (double)successCount * messageLen;                                         // total bytes
+    double elapsedSeconds = result.elapsedSeconds;                                                 // t
+    double messagesPerSecond = (double)result.successCount / elapsedSeconds;                       // msg/s
+    double totalBytes = (double)result.successCount * messageLen;                                  // total bytes
     double bytesPerSecond = totalBytes / elapsedSeconds;                                           // B/s
     
     // Report
     std::cout << "\n========== MEASUREMENT RESULTS ==========" << std::endl;
-    std::cout << "Messages: " << MESSAGE_COUNT << std::endl;
-    std::cout << "Succeeded: " << successCount << std::endl;
-    std::cout << "Errors: " << errorCount << std::endl;
+    std::cout << "Messages: " << messageCount << std::endl;
+    std::cout << "Succeeded: " << result.successCount << std::endl;
+    std::cout << "Errors: " << result.errorCount << std::endl;
+    if (result.fragments > 0) {
+        std::cout << "Fragments: " << result.fragments << " (" << result.fragments / messageCount
+                  << " per message)" << std::endl;
+    }
+    if (compress) {
+        std::cout << "Compression: " << result.rawBytes << " -> " << result.wireBytes << " payload bytes ("
+                  << std::fixed << std::setprecision(1)
+                  << (result.rawBytes > 0 ? 100.0 * result.wireBytes / result.rawBytes : 0.0) << "%), "
+                  << result.compressed << " of " << messageCount << " messages compressed, "
+                  << std::setprecision(3) << result.compressSeconds * 1e9 / messageCount << " ns/msg" << std::endl;
+    }
+    if (result.flowWaits > 0 || flow) {
+        std::cout << "Flow control: " << result.flowWaits << " waits, " << std::fixed << std::setprecision(3)
+                  << result.flowWaitSeconds << " s waiting, stalls: " << result.flowStalls << std::endl;
+    }
+    if (batchSize > 1 || coalesce) {
+        std::cout << "Batch: " << batchSize << (coalesce ? " (coalesced)" : "")
+                  << ", datagrams: " << result.datagrams << std::endl;
+    }
     std::cout << "Elapsed: " << std::fixed << std::setprecision(3) << elapsedSeconds << " s" << std::endl;
     std::cout << "Rate:    " << std::fixed << std::setprecision(2) << messagesPerSecond << " msg/s" << std::endl;
     std::cout << "Throughput: " << std::fixed << std::setprecision(2) << bytesPerSecond << " B/s" << std::endl;
     std::cout << "Throughput: " << std::fixed << std::setprecision(2) << (bytesPerSecond / 1024.0) << " KB/s" << std::endl;
+    std::cout << "CPU: " << std::fixed << std::setprecision(3) << result.cpuSeconds << " s ("
+              << result.cpuSeconds * 1e6 / messageCount << " us/msg)" << std::endl;
     std::cout << "=========================================" << std::endl;
     
     std::cout << "\nClient is exiting." << std::endl;
-    return (errorCount == 0) ? 0 : 1;          // Exit code: 0 — no write errors
+    return (result.errorCount == 0) ? 0 : 1;   // Exit code: 0 — no write errors
 }
-
@@ -0,0 +1,219 @@
+#pragma once
+
+// ------------------------------
+// MailslotBatch: batched and coalesced send path
+// MailslotBatchSender queues outgoing messages and hands them to
+// MailslotSendMany once the batch is full or the flush deadline expires.
+//
+// Coalesced frames (optional) pack several small logical messages into one
+// datagram of at most maxFrameSize bytes:
+//   [00 'M' 'S' 'C'] ([u16 length][payload])*
+// The leading NUL never starts a strlen()-terminated text message, so a
+// receiver can tell frames from plain messages; MailslotFrameReader
+// unpacks them (plain messages come out as a single entry).
+// ------------------------------
+
+#include "MailslotCredit.h"
+#include "MailslotTransport.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static const char     kCoalescedMagic[4]   = { 0x00, 'M', 'S', 'C' };
+static const uint32_t kCoalescedHeaderSize = sizeof(kCoalescedMagic);
+static const uint32_t kCoalescedEntryHeader = 2;     // u16 length (little-endian)
+
+struct MailslotBatchSender {
+    MailslotSender* sender = nullptr;
+    uint32_t batchSize = 1;               // datagrams per MailslotSendMany
+    uint32_t maxFrameSize = 0;            // slot's max message size
+    bool coalesce = false;                // pack small messages into frames
+    std::chrono::microseconds flushDeadline{0}; // 0 — flush only when full
+    bool waitWhenBusy = false;            // full shared-memory ring: retry instead of failing
+    MailslotCreditChannel* credit = nullptr;  // optional flow control (MailslotCredit.h)
+
+    std::vector<char> storage;            // batchSize * maxFrameSize bytes
+    std::vector<MailslotMessage> pending; // datagrams waiting to go out
+    uint32_t pendingCount = 0;            // used entries of pending
+    uint32_t pendingMessages = 0;         // logical messages in pending
+    std::chrono::steady_clock::time_point firstPending;
+
+    uint64_t messagesSent = 0;            // logical messages delivered
+    uint64_t datagramsSent = 0;           // datagrams (syscall payloads)
+    uint64_t bytesSent = 0;               // logical payload bytes delivered
+    uint64_t errors = 0;                  // logical messages lost to failed sends
+};
+
+// batchSize     — datagrams per flush (1 — plain synchronous sends)
+// maxFrameSize  — max message size of the target slot (nMaxMessage)
+// flushDeadline — max time a queued message may wait (0 — until batch is full)
+inline void MailslotBatchInit(MailslotBatchSender& batch, MailslotSender& sender, uint32_t batchSize,
+                              uint32_t maxFrameSize, bool coalesce,
+                              std::chrono::microseconds flushDeadline = std::chrono::microseconds(0)) {
+    batch.sender = &sender;
+    batch.batchSize = batchSize == 0 ? 1 : batchSize;
+    batch.maxFrameSize = maxFrameSize;
+    batch.coalesce = coalesce;
+    batch.flushDeadline = flushDeadline;
+    batch.storage.assign((size_t)batch.batchSize * maxFrameSize, 0);
+    batch.pending.resize(batch.batchSize);
+    for (uint32_t i = 0; i < batch.batchSize; i++) {
+        batch.pending[i].buffer = &batch.storage[(size_t)i * maxFrameSize];
+        batch.pending[i].capacity = maxFrameSize;
+        batch.pending[i].length = 0;
+    }
+    batch.pendingCount = 0;
+    batch.pendingMessages = 0;
+    batch.messagesSent = batch.datagramsSent = batch.bytesSent = batch.errors = 0;
+}
+
+// Number of logical messages packed in one queued datagram
+inline uint32_t MailslotCoalescedCount(const MailslotMessage& frame) {
+    uint32_t count = 0;
+    for (uint32_t offset = kCoalescedHeaderSize; offset + kCoalescedEntryHeader <= frame.length; count++) {
+        uint32_t length = (uint8_t)frame.buffer[offset] | ((uint32_t)(uint8_t)frame.buffer[offset + 1] << 8);
+        offset += kCoalescedEntryHeader + length;
+    }
+    return count;
+}
+
+// Write the queued datagrams; with credits, in chunks of at most the window
+inline bool MailslotBatchSendPending(MailslotBatchSender& batch, uint32_t* sent) {
+    *sent = 0;
+    while (*sent < batch.pendingCount) {
+        uint32_t chunk = batch.pendingCount - *sent;
+        if (batch.credit != nullptr) {
+            chunk = std::min(chunk, MailslotCreditWindow(*batch.credit));
+            if (!MailslotCreditAcquire(*batch.credit, chunk)) return false;
+        }
+        uint32_t done = 0;
+        bool ok = MailslotSendMany(*batch.sender, batch.pending.data() + *sent, chunk, &done);
+        while (!ok && batch.waitWhenBusy && MailslotLastError() == MAILSLOT_ERROR_BUSY) {
+            std::this_thread::yield();    // let the reader drain the ring
+            uint32_t more = 0;
+            ok = MailslotSendMany(*batch.sender, batch.pending.data() + *sent + done, chunk - done, &more);
+            done += more;
+        }
+        *sent += done;
+        if (!ok) {
+            MailslotErrorCode error = MailslotLastError();
+            if (batch.credit != nullptr) MailslotCreditRelease(*batch.credit, chunk - done);
+            MailslotSetLastError(error);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Send everything queued; returns false if any datagram failed
+inline bool MailslotBatchFlush(MailslotBatchSender& batch) {
+    if (batch.pendingCount == 0) return true;
+    uint32_t sent = 0;
+    bool ok = MailslotBatchSendPending(batch, &sent);
+    uint32_t delivered = 0;
+    for (uint32_t i = 0; i < sent; i++) {
+        uint32_t logical = batch.coalesce ? MailslotCoalescedCount(batch.pending[i]) : 1;
+        delivered += logical;
+        batch.bytesSent += batch.coalesce
+            ? batch.pending[i].length - kCoalescedHeaderSize - logical * kCoalescedEntryHeader
+            : batch.pending[i].length;
+    }
+    batch.messagesSent += delivered;
+    batch.datagramsSent += sent;
+    batch.errors += batch.pendingMessages - delivered;
+    batch.pendingCount = 0;
+    batch.pendingMessages = 0;
+    return ok;
+}
+
+// Flush if the oldest queued message waited past the deadline
+inline bool MailslotBatchPoll(MailslotBatchSender& batch) {
+    if (batch.pendingCount == 0 || batch.flushDeadline.count() == 0) return true;
+    if (std::chrono::steady_clock::now() - batch.firstPending < batch.flushDeadline) return true;
+    return MailslotBatchFlush(batch);
+}
+
+// Queue one message (copied); may flush the batch
+// Fails with MAILSLOT_ERROR_INSUFFICIENT_BUFFER when it cannot fit in a datagram.
+inline bool MailslotBatchAdd(MailslotBatchSender& batch, const void* data, uint32_t length) {
+    uint32_t need = batch.coalesce ? kCoalescedHeaderSize + kCoalescedEntryHeader + length : length;
+    if (need > batch.maxFrameSize || (batch.coalesce && length > 0xFFFF)) {
+        MailslotSetLastError(MAILSLOT_ERROR_INSUFFICIENT_BUFFER);
+        return false;
+    }
+    bool ok = true;
+
+    // Block 1: pick the datagram — the open frame if the entry still fits
+    MailslotMessage* target = nullptr;
+    if (batch.coalesce && batch.pendingCount > 0) {
+        MailslotMessage& open = batch.pending[batch.pendingCount - 1];
+        if (open.length + kCoalescedEntryHeader + length <= batch.maxFrameSize) target = &open;
+    }
+    if (target == nullptr) {
+        if (batch.pendingCount == batch.batchSize) ok = MailslotBatchFlush(batch);
+        if (batch.pendingCount == 0) batch.firstPending = std::chrono::steady_clock::now();
+        target = &batch.pending[batch.pendingCount++];
+        target->length = 0;
+        if (batch.coalesce) {
+            memcpy(target->buffer, kCoalescedMagic, kCoalescedHeaderSize);
+            target->length = kCoalescedHeaderSize;
+        }
+    }
+
+    // Block 2: copy the payload (with a length prefix inside a frame)
+    if (batch.coalesce) {
+        target->buffer[target->length++] = (char)(length & 0xFF);
+        target->buffer[target->length++] = (char)(length >> 8);
+    }
+    memcpy(target->buffer + target->length, data, length);
+    target->length += length;
+    batch.pendingMessages++;
+
+    // Block 3: plain batches go out once full; frames wait for the next add
+    if (!batch.coalesce && batch.pendingCount == batch.batchSize) {
+        if (!MailslotBatchFlush(batch)) ok = false;
+    }
+    if (!MailslotBatchPoll(batch)) ok = false;
+    return ok;
+}
+
+// ------------------------------
+// Receiver side: iterate the logical messages of one datagram
+// ------------------------------
+struct MailslotFrameReader {
+    const char* data;
+    uint32_t length;
+    uint32_t offset;
+    bool coalesced;
+};
+
+inline bool MailslotIsCoalesced(const char* data, uint32_t length) {
+    return length >= kCoalescedHeaderSize && memcmp(data, kCoalescedMagic, kCoalescedHeaderSize) == 0;
+}
+
+inline void MailslotFrameReaderInit(MailslotFrameReader& reader, const char* data, uint32_t length) {
+    reader.data = data;
+    reader.length = length;
+    reader.coalesced = MailslotIsCoalesced(data, length);
+    reader.offset = reader.coalesced ? kCoalescedHeaderSize : 0;
+}
+
+// Next logical message; false when the datagram is exhausted or malformed
+inline bool MailslotFrameReaderNext(MailslotFrameReader& reader, const char** message, uint32_t* messageLength) {
+    if (!reader.coalesced) {
+        if (reader.offset == 1) return false;
+        reader.offset = 1;                    // plain message: exactly one entry
+        *message = reader.data;
+        *messageLength = reader.length;
+        return true;
+    }
+    if (reader.offset + kCoalescedEntryHeader > reader.length) return false;
+    uint32_t length = (uint8_t)reader.data[reader.offset] |
+                      ((uint32_t)(uint8_t)reader.data[reader.offset + 1] << 8);
+    if (reader.offset + kCoalescedEntryHeader + length > reader.length) return false; // truncated
+    *message = reader.data + reader.offset + kCoalescedEntryHeader;
+    *messageLength = length;
+    reader.offset += kCoalescedEntryHeader + length;
+    return true;
+}
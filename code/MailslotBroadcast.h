@@ -0,0 +1,197 @@
+#pragma once
+
+// ------------------------------
+// MailslotBroadcast: send one message to many slots at once
+// Every target is handled by a small thread pool (one open + write per
+// target), so an unreachable or slow host only costs its own deadline
+// instead of delaying every host after it: the broadcast takes as long as
+// the slowest target, not the sum of all targets.
+//
+// A target that is still blocked (e.g. in CreateFile on an unreachable
+// host) when its deadline passes is reported as MAILSLOT_ERROR_TIMEOUT and
+// abandoned: its worker finishes in the background on shared state and
+// never touches the caller's results. Repeated broadcasts pass one
+// MailslotBroadcastInFlight: a target whose earlier send is still running
+// is skipped (MAILSLOT_ERROR_BUSY) instead of starting another worker that
+// would block behind it, so abandoned workers stay at one per target.
+// With more targets than threads the rest wait for a free worker; a target
+// whose deadline passes while it is still queued is never sent to (reported
+// with attempted == false, operation "Queued"), so no send happens after
+// the call returned. Raise threads to the target count to avoid queuing.
+// ------------------------------
+
+#include "MailslotPlatform.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+struct MailslotBroadcastTarget {
+    std::string name;                     // full slot name (\\HOST\mailslot\Box)
+    uint32_t deadlineMs = 0;              // 0 — MailslotBroadcastConfig::deadlineMs
+};
+
+struct MailslotBroadcastResult {
+    std::string name;
+    bool ok = false;
+    bool finished = false;                // false — abandoned at its deadline
+    bool skipped = false;                 // not sent: the previous send is still in flight
+    bool attempted = false;               // a worker started the send before the deadline
+    MailslotErrorCode error = 0;          // MailslotLastError of the failed step
+    const char* operation = "";           // failed step ("CreateFile", "WriteFile", "Deadline")
+    uint64_t latencyNs = 0;               // broadcast start -> target done (or deadline)
+};
+
+struct MailslotBroadcastConfig {
+    uint32_t threads = 16;                // workers (at most one per target)
+    uint32_t deadlineMs = 2000;           // default per-target deadline
+};
+
+// Per-target send: returns true on success; on failure sets *operation and
+// leaves the error in MailslotLastError (thread-local)
+typedef std::function<bool(const std::string& name, const char** operation)> MailslotBroadcastSend;
+
+// Targets with a send still running, across broadcasts (shared with the workers)
+struct MailslotBroadcastInFlight {
+    std::mutex lock;
+    std::unordered_set<std::string> names;
+};
+
+// Shared with the workers; outlives the call when a target is abandoned
+struct MailslotBroadcastState {
+    std::vector<MailslotBroadcastTarget> targets;
+    std::vector<MailslotBroadcastResult> results;
+    std::vector<size_t> pending;          // targets handed to the workers
+    MailslotBroadcastSend send;
+    std::shared_ptr<MailslotBroadcastInFlight> inFlight;   // optional
+    uint64_t startNs = 0;
+    std::atomic<size_t> next{0};
+    size_t done = 0;                      // guarded by lock (skipped targets included)
+    std::mutex lock;
+    std::condition_variable finished;
+};
+
+inline void MailslotBroadcastWorker(std::shared_ptr<MailslotBroadcastState> state) {
+    while (true) {
+        size_t next = state->next.fetch_add(1);
+        if (next >= state->pending.size()) return;
+        size_t index = state->pending[next];
+        const MailslotBroadcastTarget& target = state->targets[index];
+
+        // Block 1: queued past its deadline — leave it unsent (the caller
+        // has already reported it or is about to)
+        {
+            std::lock_guard<std::mutex> guard(state->lock);
+            uint64_t deadlineNs = (uint64_t)target.deadlineMs * 1000000ull;
+            if (MailslotNowNs() - state->startNs >= deadlineNs) {
+                if (state->inFlight) {
+                    std::lock_guard<std::mutex> flightGuard(state->inFlight->lock);
+                    state->inFlight->names.erase(target.name);
+                }
+                continue;
+            }
+            state->results[index].attempted = true;
+        }
+
+        // Block 2: send and record the outcome
+        const char* operation = "";
+        bool ok = state->send(target.name, &operation);
+        MailslotErrorCode error = ok ? 0 : MailslotLastError();
+        uint64_t latencyNs = MailslotNowNs() - state->startNs;
+        if (state->inFlight) {
+            std::lock_guard<std::mutex> guard(state->inFlight->lock);
+            state->inFlight->names.erase(state->targets[index].name);
+        }
+
+        std::lock_guard<std::mutex> guard(state->lock);
+        MailslotBroadcastResult& result = state->results[index];
+        result.ok = ok;
+        result.finished = true;
+        result.error = error;
+        result.operation = operation;
+        result.latencyNs = latencyNs;
+        state->done++;
+        state->finished.notify_all();
+    }
+}
+
+// Send to every target in parallel and wait until all are done or their
+// deadlines passed. results[i] belongs to targets[i]; a target that finished
+// after its deadline is reported as timed out, one still busy in inFlight
+// as skipped (MAILSLOT_ERROR_BUSY). Returns true if all succeeded.
+inline bool MailslotBroadcast(const std::vector<MailslotBroadcastTarget>& targets,
+                              const MailslotBroadcastConfig& config, MailslotBroadcastSend send,
+                              std::vector<MailslotBroadcastResult>* results,
+                              std::shared_ptr<MailslotBroadcastInFlight> inFlight = nullptr) {
+    std::shared_ptr<MailslotBroadcastState> state = std::make_shared<MailslotBroadcastState>();
+    state->targets = targets;
+    state->results.resize(targets.size());
+    state->send = send;
+    state->inFlight = inFlight;
+    uint32_t longestMs = 0;
+    for (size_t i = 0; i < targets.size(); i++) {
+        state->results[i].name = targets[i].name;
+        if (state->targets[i].deadlineMs == 0) state->targets[i].deadlineMs = config.deadlineMs;
+        longestMs = std::max(longestMs, state->targets[i].deadlineMs);
+    }
+
+    // Block 1: claim the targets; one still sending from an earlier call is skipped
+    for (size_t i = 0; i < targets.size(); i++) {
+        if (inFlight) {
+            std::lock_guard<std::mutex> guard(inFlight->lock);
+            if (!inFlight->names.insert(targets[i].name).second) {
+                MailslotBroadcastResult& result = state->results[i];
+                result.finished = true;
+                result.skipped = true;
+                result.error = MAILSLOT_ERROR_BUSY;
+                result.operation = "InFlight";
+                state->done++;
+                continue;
+            }
+        }
+        state->pending.push_back(i);
+    }
+
+    // Block 2: start the pool — every worker pulls the next target
+    state->startNs = MailslotNowNs();
+    size_t workers = std::min<size_t>(std::max<uint32_t>(config.threads, 1), state->pending.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < workers; i++) threads.emplace_back(MailslotBroadcastWorker, state);
+
+    // Block 3: wait for all targets or the longest deadline
+    std::unique_lock<std::mutex> lock(state->lock);
+    state->finished.wait_until(lock,
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(longestMs),
+        [&state] { return state->done == state->targets.size(); });
+    bool allDone = state->done == state->targets.size();
+
+    // Block 4: copy the results; unfinished or late targets time out
+    bool allOk = true;
+    results->assign(state->results.begin(), state->results.end());
+    for (size_t i = 0; i < results->size(); i++) {
+        MailslotBroadcastResult& result = (*results)[i];
+        uint64_t deadlineNs = (uint64_t)state->targets[i].deadlineMs * 1000000ull;
+        if (!result.skipped && (!result.finished || result.latencyNs > deadlineNs)) {
+            if (!result.finished) result.latencyNs = deadlineNs;
+            result.ok = false;
+            result.error = MAILSLOT_ERROR_TIMEOUT;
+            result.operation = result.attempted ? "Deadline" : "Queued";   // queued: never sent
+        }
+        allOk = allOk && result.ok;
+    }
+    lock.unlock();
+
+    // Workers still blocked keep the shared state alive on their own
+    for (std::thread& thread : threads) {
+        if (allDone) thread.join();
+        else thread.detach();
+    }
+    return allOk;
+}
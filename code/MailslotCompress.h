@@ -0,0 +1,423 @@
+#pragma once
+
+// ------------------------------
+// MailslotCompress: per-message payload compression
+// An LZ4-style byte codec (no entropy stage, byte-aligned sequences) with
+// an optional shared dictionary, so that even short repetitive messages
+// ("Hello from Maislot-client") shrink: matches may point back into the
+// dictionary as if it preceded the message.
+//
+// Block format — a run of sequences:
+//   token          1 byte: literal length (high 4 bits), match length - 4 (low 4 bits);
+//                  15 means "more": add following bytes while they are 255
+//   literals       literal length bytes
+//   offset         2 bytes, little endian: distance back from the current
+//                  output position (into the dictionary when it reaches
+//                  past the start of the message)
+// The last sequence has only literals and ends the block.
+//
+// A compressed message is a binary frame (MailslotFrame.h) with
+// MAILSLOT_FRAME_FLAG_COMPRESSED and an 8-byte header extension:
+//
+//   off  size  field
+//    0    4    dictionaryId   CRC32C of the dictionary, 0 — none
+//    4    4    rawLength      bytes after decompression
+//
+// One that does not fit a datagram travels as the payload of fragments
+// (MailslotFragment.h) and is decompressed after reassembly. Messages that
+// do not shrink are sent uncompressed.
+//
+// Both sides must use the same dictionary: the built-in one
+// (MailslotDefaultDictionary) or one trained from the same sample file;
+// the receiver rejects frames whose dictionaryId differs from its own.
+// ------------------------------
+
+#include "MailslotFragment.h"
+#include "MailslotFrame.h"
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct MailslotCompressionHeader {
+    uint32_t dictionaryId;
+    uint32_t rawLength;
+};
+static_assert(sizeof(MailslotCompressionHeader) == 8, "compression header layout");
+
+static const uint32_t kCompressMinMatch = 4;
+static const uint32_t kCompressMaxOffset = 65535;
+static const uint32_t kCompressHashBits = 12;         // 4096-entry match table
+static const uint32_t kDictionaryMaxSize = 32 * 1024; // dictionary + message must stay within an offset
+
+inline uint32_t MailslotCompressRead32(const char* data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline uint32_t MailslotCompressHash(uint32_t value, uint32_t bits) {
+    return (value * 2654435761u) >> (32 - bits);
+}
+
+// ------------------------------
+// Dictionary
+// ------------------------------
+struct MailslotDictionary {
+    std::string data;
+    uint32_t id = 0;                      // CRC32C of data, 0 — empty
+    std::vector<uint32_t> table;          // hash of 4 bytes -> position + 1 (last occurrence)
+};
+
+inline void MailslotDictionaryLoad(MailslotDictionary& dictionary, const std::string& data) {
+    dictionary.data = data.size() > kDictionaryMaxSize ? data.substr(data.size() - kDictionaryMaxSize) : data;
+    dictionary.id = dictionary.data.empty() ? 0 : MailslotCrc32c(dictionary.data.data(), dictionary.data.size());
+    if (dictionary.id == 0 && !dictionary.data.empty()) dictionary.id = 1;
+    dictionary.table.assign((size_t)1 << kCompressHashBits, 0);
+    const char* bytes = dictionary.data.data();
+    uint32_t length = (uint32_t)dictionary.data.size();
+    for (uint32_t position = 0; position + kCompressMinMatch <= length; position++) {
+        dictionary.table[MailslotCompressHash(MailslotCompressRead32(bytes + position), kCompressHashBits)] = position + 1;
+    }
+}
+
+// Train a dictionary from sample payloads: greedily pick the 32-byte sample
+// segments whose 6-byte substrings recur most often across the samples,
+// until maxSize bytes are collected. The most useful segment goes last
+// (closest to the message, the shortest offsets). Deterministic, so both
+// sides can train from the same samples.
+inline std::string MailslotDictionaryTrain(const std::vector<std::string>& samples, uint32_t maxSize = 1024) {
+    const size_t gram = 6, segment = 32, step = 8;
+    std::unordered_map<std::string, uint32_t> frequency;
+    std::vector<std::string> candidates;
+    std::unordered_set<std::string> seen;
+    for (const std::string& sample : samples) {
+        for (size_t i = 0; i + gram <= sample.size(); i++) frequency[sample.substr(i, gram)]++;
+        for (size_t i = 0; i < sample.size(); i += step) {
+            std::string piece = sample.substr(i, segment);
+            if (piece.size() >= gram && seen.insert(piece).second) candidates.push_back(piece);
+            if (i + segment >= sample.size()) break;
+        }
+    }
+
+    std::vector<std::string> chosen;
+    size_t total = 0;
+    while (total < maxSize && !candidates.empty()) {
+        // Block 1: score = occurrences of the grams not covered yet
+        size_t best = 0;
+        uint64_t bestScore = 0;
+        for (size_t c = 0; c < candidates.size(); c++) {
+            uint64_t score = 0;
+            for (size_t i = 0; i + gram <= candidates[c].size(); i++) {
+                auto found = frequency.find(candidates[c].substr(i, gram));
+                if (found != frequency.end() && found->second > 1) score += found->second;
+            }
+            if (score > bestScore) {
+                bestScore = score;
+                best = c;
+            }
+        }
+        if (bestScore == 0) break;        // nothing recurs any more
+
+        // Block 2: take it and mark its grams as covered
+        const std::string& piece = candidates[best];
+        for (size_t i = 0; i + gram <= piece.size(); i++) frequency[piece.substr(i, gram)] = 0;
+        total += piece.size();
+        chosen.push_back(piece);
+        candidates.erase(candidates.begin() + best);
+    }
+
+    std::string dictionary;
+    for (auto it = chosen.rbegin(); it != chosen.rend(); ++it) dictionary += *it;
+    if (dictionary.size() > maxSize) dictionary.erase(0, dictionary.size() - maxSize);
+    return dictionary;
+}
+
+// Train from a sample file, one payload per line
+inline bool MailslotDictionaryTrainFile(MailslotDictionary& dictionary, const std::string& path,
+                                        uint32_t maxSize = 1024) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        MailslotSetLastError(MAILSLOT_ERROR_NOT_FOUND);
+        return false;
+    }
+    std::vector<std::string> samples;
+    std::string line;
+    size_t bytes = 0;
+    while (bytes < (1u << 20) && std::getline(file, line)) {   // first 1 MB of samples
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        bytes += line.size();
+        samples.push_back(line);
+    }
+    MailslotDictionaryLoad(dictionary, MailslotDictionaryTrain(samples, maxSize));
+    return true;
+}
+
+// Built-in dictionary, trained from the payloads the clients send
+inline const MailslotDictionary& MailslotDefaultDictionary() {
+    static const MailslotDictionary dictionary = [] {
+        std::vector<std::string> samples = {
+            "Hello from Maislot-client",
+            "Hello from Maislot-client Hello from Maislot-client",
+            "Hello from Maislot-client Hello from Maislot-client Hello from Maislot-client",
+        };
+        MailslotDictionary trained;
+        MailslotDictionaryLoad(trained, MailslotDictionaryTrain(samples));
+        return trained;
+    }();
+    return dictionary;
+}
+
+// ------------------------------
+// Codec
+// ------------------------------
+
+// Worst case for an incompressible input
+inline uint32_t MailslotCompressBound(uint32_t length) {
+    return length + length / 255 + 16;
+}
+
+inline bool MailslotCompressPutLength(char** out, const char* end, uint32_t length) {
+    char* op = *out;
+    for (; length >= 255; length -= 255) {
+        if (op >= end) return false;
+        *op++ = (char)255;
+    }
+    if (op >= end) return false;
+    *op++ = (char)length;
+    *out = op;
+    return true;
+}
+
+// One sequence; matchLength == 0 — the final literal run
+inline bool MailslotCompressPutSequence(char** out, const char* end, const char* literals, uint32_t literalLength,
+                                        uint32_t offset, uint32_t matchLength) {
+    char* op = *out;
+    uint32_t matchCode = matchLength == 0 ? 0 : matchLength - kCompressMinMatch;
+    if ((uint64_t)(end - op) < 1 + (uint64_t)literalLength) return false;
+    char* token = op++;
+    *token = (char)((std::min<uint32_t>(literalLength, 15) << 4) | std::min<uint32_t>(matchCode, 15));
+    if (literalLength >= 15 && !MailslotCompressPutLength(&op, end, literalLength - 15)) return false;
+    if ((uint64_t)(end - op) < literalLength) return false;
+    memcpy(op, literals, literalLength);
+    op += literalLength;
+    if (matchLength != 0) {
+        if (end - op < 2) return false;
+        *op++ = (char)(offset & 0xFF);
+        *op++ = (char)(offset >> 8);
+        if (matchCode >= 15 && !MailslotCompressPutLength(&op, end, matchCode - 15)) return false;
+    }
+    *out = op;
+    return true;
+}
+
+// Compress length bytes into dst; returns the compressed size, or 0 when it
+// does not fit in capacity (pass capacity < length to require a gain)
+inline uint32_t MailslotCompress(const MailslotDictionary* dictionary, const char* src, uint32_t length,
+                                 char* dst, uint32_t capacity) {
+    const char* dict = dictionary != nullptr ? dictionary->data.data() : nullptr;
+    uint32_t dictLength = dictionary != nullptr ? (uint32_t)dictionary->data.size() : 0;
+    char* op = dst;
+    const char* end = dst + capacity;
+
+    // Match table sized to the input, so short messages clear only a few entries
+    thread_local uint32_t table[1u << kCompressHashBits];
+    uint32_t bits = 6;
+    while (bits < kCompressHashBits && (1u << bits) < length) bits++;
+    memset(table, 0, sizeof(uint32_t) << bits);
+
+    uint32_t anchor = 0;                  // first byte not yet emitted
+    uint32_t position = 0;
+    uint32_t misses = 0;
+    while (length >= kCompressMinMatch && position <= length - kCompressMinMatch) {
+        // Block 1: candidate in the message, then in the dictionary
+        uint32_t sequence = MailslotCompressRead32(src + position);
+        uint32_t* slot = &table[MailslotCompressHash(sequence, bits)];
+        uint32_t candidate = *slot;
+        *slot = position + 1;
+        const char* ref = nullptr;
+        const char* refBegin = nullptr;
+        const char* refEnd = nullptr;
+        uint32_t offset = 0;
+        if (candidate != 0 && position - (candidate - 1) <= kCompressMaxOffset &&
+            MailslotCompressRead32(src + candidate - 1) == sequence) {
+            ref = src + candidate - 1;
+            refBegin = src;
+            refEnd = src + length;
+            offset = position - (candidate - 1);
+        } else if (dictLength != 0) {
+            uint32_t entry = dictionary->table[MailslotCompressHash(sequence, kCompressHashBits)];
+            if (entry != 0 && (uint64_t)position + dictLength - (entry - 1) <= kCompressMaxOffset &&
+                MailslotCompressRead32(dict + entry - 1) == sequence) {
+                ref = dict + entry - 1;
+                refBegin = dict;
+                refEnd = dict + dictLength;
+                offset = position + dictLength - (entry - 1);
+            }
+        }
+        if (ref == nullptr) {
+            position += 1 + (misses++ >> 5);          // skip faster through data that does not match
+            continue;
+        }
+        misses = 0;
+
+        // Block 2: extend the match forward, then back over pending literals
+        uint32_t matchLength = kCompressMinMatch;
+        while (position + matchLength < length && ref + matchLength < refEnd &&
+               src[position + matchLength] == ref[matchLength]) {
+            matchLength++;
+        }
+        while (position > anchor && ref > refBegin && src[position - 1] == ref[-1]) {
+            position--;
+            ref--;
+            matchLength++;
+        }
+
+        // Block 3: emit literals + match
+        if (!MailslotCompressPutSequence(&op, end, src + anchor, position - anchor, offset, matchLength)) return 0;
+        position += matchLength;
+        anchor = position;
+        if (position >= 2 && position - 2 + kCompressMinMatch <= length) {
+            table[MailslotCompressHash(MailslotCompressRead32(src + position - 2), bits)] = position - 1;
+        }
+    }
+    if (!MailslotCompressPutSequence(&op, end, src + anchor, length - anchor, 0, 0)) return 0;
+    return (uint32_t)(op - dst);
+}
+
+inline bool MailslotDecompressGetLength(const uint8_t** in, const uint8_t* end, uint32_t* length) {
+    const uint8_t* ip = *in;
+    uint32_t value;
+    do {
+        if (ip >= end || *length > (1u << 30)) return false;
+        value = *ip++;
+        *length += value;
+    } while (value == 255);
+    *in = ip;
+    return true;
+}
+
+// Decompress into dst, which holds exactly rawLength bytes; false for
+// corrupt input (never reads or writes out of bounds)
+inline bool MailslotDecompress(const MailslotDictionary* dictionary, const char* src, uint32_t length,
+                               char* dst, uint32_t rawLength) {
+    const char* dict = dictionary != nullptr ? dictionary->data.data() : nullptr;
+    uint32_t dictLength = dictionary != nullptr ? (uint32_t)dictionary->data.size() : 0;
+    const uint8_t* ip = (const uint8_t*)src;
+    const uint8_t* end = ip + length;
+    uint32_t out = 0;
+    while (ip < end) {
+        uint32_t token = *ip++;
+        uint32_t literalLength = token >> 4;
+        if (literalLength == 15 && !MailslotDecompressGetLength(&ip, end, &literalLength)) return false;
+        if ((uint64_t)(end - ip) < literalLength || rawLength - out < literalLength) return false;
+        memcpy(dst + out, ip, literalLength);
+        ip += literalLength;
+        out += literalLength;
+        if (ip == end) break;             // final literal run
+
+        if (end - ip < 2) return false;
+        uint32_t offset = (uint32_t)ip[0] | (uint32_t)ip[1] << 8;
+        ip += 2;
+        uint32_t matchLength = token & 15;
+        if (matchLength == 15 && !MailslotDecompressGetLength(&ip, end, &matchLength)) return false;
+        matchLength += kCompressMinMatch;
+        if (offset == 0 || rawLength - out < matchLength) return false;
+
+        // Match that starts in the dictionary (may continue into the output)
+        if (offset > out) {
+            uint32_t back = offset - out;
+            if (back > dictLength) return false;
+            uint32_t piece = std::min(back, matchLength);
+            memcpy(dst + out, dict + dictLength - back, piece);
+            out += piece;
+            matchLength -= piece;
+        }
+        char* op = dst + out;
+        const char* ref = op - offset;
+        if (offset >= matchLength) {
+            memcpy(op, ref, matchLength);
+        } else {
+            for (uint32_t i = 0; i < matchLength; i++) op[i] = ref[i];   // overlapping run
+        }
+        out += matchLength;
+    }
+    return out == rawLength;
+}
+
+// ------------------------------
+// Send side
+// ------------------------------
+struct MailslotCompressor {
+    const MailslotDictionary* dictionary = nullptr;
+    std::vector<char> scratch;            // one compressed frame
+    uint64_t compressed = 0;              // messages sent compressed
+    uint64_t stored = 0;                  // messages sent as is (did not shrink)
+    uint64_t rawBytes = 0;                // payload bytes offered
+    uint64_t wireBytes = 0;               // payload bytes after compression (stored ones included)
+    uint64_t compressNs = 0;              // time spent in MailslotCompress
+};
+
+inline void MailslotCompressorInit(MailslotCompressor& compressor, const MailslotDictionary* dictionary) {
+    compressor = MailslotCompressor();
+    compressor.dictionary = dictionary;
+}
+
+// Queue one message compressed: one frame when it fits a datagram,
+// fragments of the compressed frame otherwise, or uncompressed (through
+// MailslotFragmentSend) when compression does not pay for its header.
+inline bool MailslotCompressedSend(MailslotCompressor& compressor, MailslotFragmentWriter& writer,
+                                   MailslotBatchSender& batch, const char* data, uint32_t length) {
+    const uint16_t extension = sizeof(MailslotCompressionHeader) + MailslotFrameDeadlineSize(writer.deadlineMs);
+    size_t needed = sizeof(MailslotFrameHeader) + extension + MailslotCompressBound(length);
+    if (compressor.scratch.size() < needed) compressor.scratch.resize(needed);
+    char* frame = compressor.scratch.data();
+    compressor.rawBytes += length;
+
+    // Block 1: compress; it must save more than the extension
+    uint64_t beginNs = MailslotNowNs();
+    uint32_t packed = length > extension
+        ? MailslotCompress(compressor.dictionary, data, length, MailslotFramePayload(frame, extension), length - extension - 1)
+        : 0;
+    compressor.compressNs += MailslotNowNs() - beginNs;
+    if (packed == 0) {
+        compressor.stored++;
+        compressor.wireBytes += length;
+        return MailslotFragmentSend(writer, batch, data, length);
+    }
+    compressor.compressed++;
+    compressor.wireBytes += packed;
+
+    // Block 2: seal; a datagram-sized frame goes out as is
+    MailslotCompressionHeader header;
+    header.dictionaryId = compressor.dictionary != nullptr ? compressor.dictionary->id : 0;
+    header.rawLength = length;
+    memcpy(frame + sizeof(MailslotFrameHeader), &header, sizeof(header));
+    uint8_t flags = MAILSLOT_FRAME_FLAG_COMPRESSED | MailslotFrameSetDeadline(frame, extension, writer.deadlineMs);
+    uint32_t total = sizeof(MailslotFrameHeader) + extension + packed;
+    if (total <= MailslotFragmentFrameSize(writer, batch)) {
+        MailslotFrameSeal(frame, writer.senderId, writer.sequence++, packed, 0, flags, extension);
+        return MailslotBatchAdd(batch, frame, total);
+    }
+
+    // Block 3: larger — the sealed frame is the message carried by fragments
+    // (its own sequence is the message id: datagram sequences stay gapless)
+    MailslotFrameSeal(frame, writer.senderId, writer.messageId, packed, 0, flags, extension);
+    return MailslotFragmentSend(writer, batch, frame, total);
+}
+
+// ------------------------------
+// Receive side
+// ------------------------------
+inline bool MailslotIsCompressed(const MailslotFrameView& frame) {
+    return (frame.header->flags & MAILSLOT_FRAME_FLAG_COMPRESSED) != 0 &&
+           frame.extensionLength >= sizeof(MailslotCompressionHeader);
+}
+
+inline MailslotCompressionHeader MailslotCompressionInfo(const MailslotFrameView& frame) {
+    MailslotCompressionHeader header;
+    memcpy(&header, frame.extension, sizeof(header));
+    return header;
+}
@@ -0,0 +1,300 @@
+#pragma once
+
+// ------------------------------
+// MailslotCredit: credit-based flow control between senders and a server
+// The server publishes how many datagrams it has consumed in a small
+// shared segment next to its slot (<segment>.credit, see MailslotRing.h
+// for the naming). Senders take credits before writing:
+//
+//   in flight = granted - consumed      (all senders together)
+//   a sender may write n datagrams while in flight + n <= window
+//
+// so the slot never holds more than `window` unprocessed datagrams and
+// senders run exactly as fast as the server consumes — no BUSY errors on a
+// full ring, no unbounded queue in a kernel mailslot. A sender that has to
+// wait spins briefly and then sleeps on a futex (Linux) or a named event
+// (Windows); the server wakes sleepers only when there are any.
+// Credits count every datagram the server consumes or drops, so senders
+// without flow control only loosen the window. If the server stops
+// consuming for stallMs, a waiting sender proceeds anyway (counted as a
+// stall) and the outstanding credits are resynchronised to one window, so a
+// lost datagram cannot shrink the window or block senders for good.
+// ------------------------------
+
+#include "MailslotRing.h"
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <string>
+#include <thread>
+
+#define MAILSLOT_CREDIT_MAGIC   0x54445243u   // "CRDT"
+#define MAILSLOT_CREDIT_VERSION 1u
+
+struct MailslotCreditHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t window;                            // datagrams allowed in flight
+    uint32_t reserved;
+    uint64_t ownerPid;
+    std::atomic<uint32_t> ownerAlive;           // 1 while the server publishes
+    alignas(64) std::atomic<uint64_t> granted;  // credits taken by senders
+    alignas(64) std::atomic<uint64_t> consumed; // datagrams processed by the server
+    std::atomic<uint32_t> waiters;              // senders parked
+    std::atomic<uint32_t> releaseSeq;           // futex word
+};
+
+struct MailslotCreditChannel {
+    MailslotCreditHeader* header = nullptr;
+    size_t mappingSize = 0;
+    std::string segmentName;
+    bool owner = false;
+#ifdef _WIN32
+    HANDLE mapping = NULL;
+    HANDLE releaseEvent = NULL;
+#endif
+    // Sender-side counters (this process)
+    uint64_t waits = 0;                         // acquisitions that had to wait
+    uint64_t waitNs = 0;                        // total time spent waiting
+    uint64_t stalls = 0;                        // waits that gave up after stallMs
+};
+
+inline bool MailslotCreditSegmentName(const std::string& name, std::string* segment) {
+    if (!MailslotRingSegmentName(name, segment)) return false;
+    *segment += ".credit";
+    return true;
+}
+
+inline void MailslotCreditUnmap(MailslotCreditChannel& channel) {
+    if (channel.header == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(channel.header);
+    CloseHandle(channel.mapping);
+    if (channel.releaseEvent != NULL) CloseHandle(channel.releaseEvent);
+    channel.mapping = NULL;
+    channel.releaseEvent = NULL;
+#else
+    munmap(channel.header, channel.mappingSize);
+#endif
+    channel.header = nullptr;
+}
+
+// Server side: create the channel for slot `name` with `window` credits.
+// Call after MailslotCreate succeeded (a live server already owns the slot).
+inline bool MailslotCreditCreate(MailslotCreditChannel& channel, const std::string& name, uint32_t window) {
+    if (window == 0) {
+        MailslotSetLastError(MAILSLOT_ERROR_INVALID_PARAMETER);
+        return false;
+    }
+    if (!MailslotCreditSegmentName(name, &channel.segmentName)) return false;
+    channel.mappingSize = sizeof(MailslotCreditHeader);
+#ifdef _WIN32
+    std::wstring segment = MailslotWideName(channel.segmentName);
+    channel.mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                         0, (DWORD)channel.mappingSize, segment.c_str());
+    if (channel.mapping == NULL) return false;
+    std::wstring releaseName = segment + L".release";
+    channel.releaseEvent = CreateEventW(NULL, FALSE, FALSE, releaseName.c_str());  // auto reset
+    void* base = MapViewOfFile(channel.mapping, FILE_MAP_ALL_ACCESS, 0, 0, channel.mappingSize);
+    if (channel.releaseEvent == NULL || base == NULL) {
+        DWORD error = GetLastError();
+        if (base != NULL) UnmapViewOfFile(base);
+        if (channel.releaseEvent != NULL) CloseHandle(channel.releaseEvent);
+        CloseHandle(channel.mapping);
+        channel.mapping = NULL;
+        channel.releaseEvent = NULL;
+        SetLastError(error);
+        return false;
+    }
+    uint64_t ownerPid = GetCurrentProcessId();
+#else
+    shm_unlink(channel.segmentName.c_str());    // left over from a crashed server
+    int fd = shm_open(channel.segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+    if (fd < 0) return false;
+    if (ftruncate(fd, (off_t)channel.mappingSize) != 0) {
+        int error = errno;
+        close(fd);
+        shm_unlink(channel.segmentName.c_str());
+        errno = error;
+        return false;
+    }
+    void* base = mmap(NULL, channel.mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        int error = errno;
+        shm_unlink(channel.segmentName.c_str());
+        errno = error;
+        return false;
+    }
+    uint64_t ownerPid = (uint64_t)getpid();
+#endif
+    channel.header = new (base) MailslotCreditHeader();
+    channel.header->magic = MAILSLOT_CREDIT_MAGIC;
+    channel.header->version = MAILSLOT_CREDIT_VERSION;
+    channel.header->window = window;
+    channel.header->ownerPid = ownerPid;
+    channel.header->granted.store(0, std::memory_order_relaxed);
+    channel.header->consumed.store(0, std::memory_order_relaxed);
+    channel.header->waiters.store(0, std::memory_order_relaxed);
+    channel.header->releaseSeq.store(0, std::memory_order_relaxed);
+    channel.header->ownerAlive.store(1, std::memory_order_release);   // publish
+    channel.owner = true;
+    return true;
+}
+
+// Sender side: attach to the server's channel.
+// Fails with MAILSLOT_ERROR_NOT_FOUND when the server runs without credits.
+inline bool MailslotCreditOpen(MailslotCreditChannel& channel, const std::string& name) {
+    if (!MailslotCreditSegmentName(name, &channel.segmentName)) return false;
+    void* base = NULL;
+#ifdef _WIN32
+    std::wstring segment = MailslotWideName(channel.segmentName);
+    channel.mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, segment.c_str());
+    if (channel.mapping == NULL) {
+        MailslotSetLastError(MAILSLOT_ERROR_NOT_FOUND);
+        return false;
+    }
+    std::wstring releaseName = segment + L".release";
+    channel.releaseEvent = OpenEventW(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, releaseName.c_str());
+    base = MapViewOfFile(channel.mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(MailslotCreditHeader));
+    if (channel.releaseEvent == NULL || base == NULL) {
+        if (base != NULL) UnmapViewOfFile(base);
+        if (channel.releaseEvent != NULL) CloseHandle(channel.releaseEvent);
+        CloseHandle(channel.mapping);
+        channel.mapping = NULL;
+        channel.releaseEvent = NULL;
+        MailslotSetLastError(MAILSLOT_ERROR_NOT_FOUND);
+        return false;
+    }
+    channel.mappingSize = sizeof(MailslotCreditHeader);
+#else
+    int fd = shm_open(channel.segmentName.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) return false;                 // ENOENT == MAILSLOT_ERROR_NOT_FOUND
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(MailslotCreditHeader)) {
+        close(fd);
+        errno = MAILSLOT_ERROR_NOT_FOUND;
+        return false;
+    }
+    channel.mappingSize = sizeof(MailslotCreditHeader);
+    base = mmap(NULL, channel.mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+#endif
+    channel.header = (MailslotCreditHeader*)base;
+    channel.owner = false;
+    if (channel.header->ownerAlive.load(std::memory_order_acquire) == 0 ||
+        channel.header->magic != MAILSLOT_CREDIT_MAGIC || channel.header->version != MAILSLOT_CREDIT_VERSION) {
+        MailslotCreditUnmap(channel);
+        MailslotSetLastError(MAILSLOT_ERROR_NOT_FOUND);
+        return false;
+    }
+    return true;
+}
+
+inline void MailslotCreditClose(MailslotCreditChannel& channel) {
+    if (channel.header == nullptr) return;
+    if (channel.owner) {
+        channel.header->ownerAlive.store(0, std::memory_order_release);
+        channel.header->releaseSeq.fetch_add(1, std::memory_order_release);
+#ifdef _WIN32
+        SetEvent(channel.releaseEvent);         // let waiting senders see the close
+#else
+        syscall(SYS_futex, &channel.header->releaseSeq, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+        shm_unlink(channel.segmentName.c_str());
+#endif
+    }
+    MailslotCreditUnmap(channel);
+}
+
+inline uint32_t MailslotCreditWindow(const MailslotCreditChannel& channel) {
+    return channel.header->window;
+}
+
+// ------------------------------
+// Server: report consumed datagrams (wakes parked senders).
+// Also call it for datagrams the server drops, or their credits are lost.
+// ------------------------------
+inline void MailslotCreditConsume(MailslotCreditChannel& channel, uint32_t count) {
+    MailslotCreditHeader* header = channel.header;
+    if (count == 0) return;
+    header->consumed.fetch_add(count, std::memory_order_seq_cst);
+    if (header->waiters.load(std::memory_order_seq_cst) == 0) return;
+    header->releaseSeq.fetch_add(1, std::memory_order_release);
+#ifdef _WIN32
+    SetEvent(channel.releaseEvent);             // auto reset: stays set until a waiter takes it
+#else
+    syscall(SYS_futex, &header->releaseSeq, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+#endif
+}
+
+// ------------------------------
+// Sender: take count credits (at most the window), waiting as needed
+// Returns false with MAILSLOT_ERROR_BROKEN_PIPE when the server went away.
+// ------------------------------
+inline bool MailslotCreditAcquire(MailslotCreditChannel& channel, uint32_t count, uint32_t stallMs = 1000) {
+    MailslotCreditHeader* header = channel.header;
+    const int64_t window = header->window;
+    count = std::min<uint32_t>(count, header->window);
+    uint64_t waitStartNs = 0;
+    for (int spins = 0;; spins++) {
+        uint64_t granted = header->granted.load(std::memory_order_relaxed);
+        uint64_t consumed = header->consumed.load(std::memory_order_acquire);
+        bool fits = (int64_t)(granted + count - consumed) <= window;
+        if (fits && header->granted.compare_exchange_weak(granted, granted + count, std::memory_order_acq_rel)) {
+            if (waitStartNs != 0) channel.waitNs += MailslotNowNs() - waitStartNs;
+            return true;
+        }
+        if (fits) continue;                     // lost a race with another sender
+
+        // Block 1: no credit — give up on a dead server, proceed after a stall
+        if (header->ownerAlive.load(std::memory_order_acquire) == 0) {
+            MailslotSetLastError(MAILSLOT_ERROR_BROKEN_PIPE);
+            return false;
+        }
+        uint64_t nowNs = MailslotNowNs();
+        if (waitStartNs == 0) {
+            waitStartNs = nowNs;
+            channel.waits++;
+        } else if (nowNs - waitStartNs > (uint64_t)stallMs * 1000000ull) {
+            // Proceed, and write off credits that were never consumed: one
+            // window (this send included) is outstanding from here on
+            uint64_t resync = header->consumed.load(std::memory_order_acquire) + (uint64_t)window;
+            while (granted > resync &&
+                   !header->granted.compare_exchange_weak(granted, resync, std::memory_order_acq_rel)) {
+            }
+            channel.stalls++;
+            channel.waitNs += nowNs - waitStartNs;
+            return true;
+        }
+
+        // Block 2: spin briefly, then park until the server consumes more
+        if (spins < 64) {
+            std::this_thread::yield();
+            continue;
+        }
+        uint32_t seq = header->releaseSeq.load(std::memory_order_acquire);
+        header->waiters.fetch_add(1, std::memory_order_seq_cst);
+        consumed = header->consumed.load(std::memory_order_seq_cst);
+        granted = header->granted.load(std::memory_order_relaxed);
+        if ((int64_t)(granted + count - consumed) > window) {
+#ifdef _WIN32
+            (void)seq;
+            // One waiter takes the signal and passes it on to the next
+            if (WaitForSingleObject(channel.releaseEvent, 1) == WAIT_OBJECT_0 &&
+                header->waiters.load(std::memory_order_seq_cst) > 1) {
+                SetEvent(channel.releaseEvent);
+            }
+#else
+            timespec timeout = { 0, 10 * 1000000L };    // recheck stall / owner every 10 ms
+            syscall(SYS_futex, &header->releaseSeq, FUTEX_WAIT, seq, &timeout, NULL, 0);
+#endif
+        }
+        header->waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
+
+// Sender: give back credits for datagrams that were not delivered
+inline void MailslotCreditRelease(MailslotCreditChannel& channel, uint32_t count) {
+    channel.header->granted.fetch_sub(count, std::memory_order_acq_rel);
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+// ------------------------------
+// MailslotEventLoop: one thread servicing many mailslots
+// Every slot gets its own dispatch callback and its own idle timeout;
+// readiness comes from a single epoll set (Linux) or I/O completion port
+// with overlapped reads (Windows), so N slots cost one thread instead of
+// N blocked ReadFile calls.
+//
+// Idle timeouts live in a min-heap with lazy re-arming: receiving a message
+// only moves the slot's deadline, the heap is fixed up when an entry expires.
+// Kernel-mode slots only (the shared-memory ring has no waitable handle).
+// ------------------------------
+
+#include "MailslotTransport.h"
+#include <functional>
+#include <memory>
+#include <queue>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/epoll.h>
+#endif
+
+struct MailslotLoopSlot;
+
+// Called for every received message (one datagram)
+typedef std::function<void(MailslotLoopSlot& slot, const char* data, uint32_t length)> MailslotMessageHandler;
+// Called when a slot was idle for its timeout; return true to keep the slot
+typedef std::function<bool(MailslotLoopSlot& slot)> MailslotTimeoutHandler;
+
+struct MailslotLoopSlot {
+    int index = -1;                       // position in the loop
+    MailslotServer server;
+    uint32_t timeoutMs = MAILSLOT_WAIT_FOREVER; // idle timeout (per slot)
+    MailslotMessageHandler onMessage;
+    MailslotTimeoutHandler onTimeout;     // empty — close the slot on timeout
+    std::chrono::steady_clock::time_point deadline;
+    uint64_t messageCount = 0;
+    bool open = false;
+    std::vector<char> buffer;             // maxMessageSize bytes (Windows read target)
+#ifdef _WIN32
+    OVERLAPPED overlapped;                // outstanding read
+#endif
+};
+
+struct MailslotEventLoop {
+    std::vector<std::unique_ptr<MailslotLoopSlot>> slots;
+    size_t openSlots = 0;
+    bool stopped = false;
+
+    // (deadline, slot index) — earliest first
+    typedef std::pair<std::chrono::steady_clock::time_point, int> Deadline;
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> deadlines;
+
+#ifdef _WIN32
+    HANDLE port = NULL;
+#else
+    int epollFd = -1;
+    std::vector<char> batchStorage;       // MAILSLOT_BATCH_MAX * largest slot size
+    MailslotMessage batch[MAILSLOT_BATCH_MAX];
+#endif
+};
+
+inline bool MailslotLoopInit(MailslotEventLoop& loop) {
+    loop.stopped = false;
+#ifdef _WIN32
+    loop.port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+    return loop.port != NULL;
+#else
+    loop.epollFd = epoll_create1(EPOLL_CLOEXEC);
+    return loop.epollFd >= 0;
+#endif
+}
+
+inline void MailslotLoopCloseSlot(MailslotEventLoop& loop, MailslotLoopSlot& slot) {
+    if (!slot.open) return;
+#ifndef _WIN32
+    epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, slot.server.handle, NULL);
+#endif
+    MailslotClose(slot.server);           // Windows: cancels the pending read
+    slot.open = false;
+    loop.openSlots--;
+}
+
+#ifdef _WIN32
+// Post the next overlapped read; completions arrive on the loop's port
+inline bool MailslotLoopArmRead(MailslotLoopSlot& slot) {
+    memset(&slot.overlapped, 0, sizeof(slot.overlapped));
+    if (!ReadFile(slot.server.handle, slot.buffer.data(), (DWORD)slot.buffer.size(), NULL, &slot.overlapped) &&
+        GetLastError() != ERROR_IO_PENDING) {
+        return false;
+    }
+    return true;
+}
+#endif
+
+// Create a slot and register it with the loop
+// timeoutMs — idle timeout for this slot (MAILSLOT_WAIT_FOREVER — none)
+// Returns the slot index, or -1 with the last error set.
+inline int MailslotLoopAdd(MailslotEventLoop& loop, const std::string& name, uint32_t maxMessageSize,
+                           uint32_t timeoutMs, MailslotMessageHandler onMessage,
+                           MailslotTimeoutHandler onTimeout = MailslotTimeoutHandler()) {
+    std::unique_ptr<MailslotLoopSlot> slot(new MailslotLoopSlot());
+    slot->index = (int)loop.slots.size();
+    slot->timeoutMs = timeoutMs;
+    slot->onMessage = onMessage;
+    slot->onTimeout = onTimeout;
+    slot->buffer.resize(maxMessageSize == 0 ? 65536 : maxMessageSize);
+
+    // The loop owns timeouts, so the slot itself never times out a read
+    if (!MailslotCreate(slot->server, name, maxMessageSize, MAILSLOT_WAIT_FOREVER)) return -1;
+#ifdef _WIN32
+    if (CreateIoCompletionPort(slot->server.handle, loop.port, (ULONG_PTR)slot->index, 0) == NULL ||
+        !MailslotLoopArmRead(*slot)) {
+        DWORD error = GetLastError();
+        MailslotClose(slot->server);
+        SetLastError(error);
+        return -1;
+    }
+#else
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = (uint32_t)slot->index;
+    if (epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, slot->server.handle, &event) != 0) {
+        int error = errno;
+        MailslotClose(slot->server);
+        errno = error;
+        return -1;
+    }
+    // Shared receive batch, sized for the largest slot
+    uint32_t slotSize = (uint32_t)slot->buffer.size();
+    if ((size_t)slotSize * MAILSLOT_BATCH_MAX > loop.batchStorage.size()) {
+        loop.batchStorage.resize((size_t)slotSize * MAILSLOT_BATCH_MAX);
+        for (uint32_t i = 0; i < MAILSLOT_BATCH_MAX; i++) {
+            loop.batch[i].buffer = &loop.batchStorage[(size_t)i * slotSize];
+            loop.batch[i].capacity = slotSize;
+            loop.batch[i].length = 0;
+        }
+    }
+#endif
+    slot->open = true;
+    if (timeoutMs != MAILSLOT_WAIT_FOREVER) {
+        slot->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        loop.deadlines.push(MailslotEventLoop::Deadline(slot->deadline, slot->index));
+    }
+    loop.openSlots++;
+    loop.slots.push_back(std::move(slot));
+    return (int)loop.slots.size() - 1;
+}
+
+inline void MailslotLoopDispatch(MailslotLoopSlot& slot, const char* data, uint32_t length) {
+    slot.messageCount++;
+    if (slot.timeoutMs != MAILSLOT_WAIT_FOREVER) {
+        slot.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(slot.timeoutMs);
+    }
+    if (slot.onMessage) slot.onMessage(slot, data, length);
+}
+
+// Fire expired idle timeouts; returns the wait (ms) until the next deadline
+inline int MailslotLoopExpire(MailslotEventLoop& loop) {
+    typedef std::chrono::steady_clock Clock;
+    while (!loop.deadlines.empty()) {
+        MailslotEventLoop::Deadline top = loop.deadlines.top();
+        MailslotLoopSlot& slot = *loop.slots[top.second];
+        if (!slot.open) {                     // closed meanwhile
+            loop.deadlines.pop();
+            continue;
+        }
+        Clock::time_point now = Clock::now();
+        if (slot.deadline > top.first) {      // activity since the entry was pushed
+            loop.deadlines.pop();
+            loop.deadlines.push(MailslotEventLoop::Deadline(slot.deadline, top.second));
+            continue;
+        }
+        if (top.first > now) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(top.first - now).count();
+            return (int)left + 1;
+        }
+        loop.deadlines.pop();
+        if (slot.onTimeout && slot.onTimeout(slot)) {
+            slot.deadline = now + std::chrono::milliseconds(slot.timeoutMs);
+            loop.deadlines.push(MailslotEventLoop::Deadline(slot.deadline, slot.index));
+        } else {
+            MailslotLoopCloseSlot(loop, slot);
+        }
+    }
+    return -1;                                // no deadlines — wait forever
+}
+
+// Run until MailslotLoopStop or until every slot is closed
+// Returns false on a readiness error (last error set).
+inline bool MailslotLoopRun(MailslotEventLoop& loop) {
+    const int EVENT_BATCH = 64;
+    while (!loop.stopped && loop.openSlots > 0) {
+        int waitMs = MailslotLoopExpire(loop);
+        if (loop.openSlots == 0) break;
+#ifdef _WIN32
+        OVERLAPPED_ENTRY entries[EVENT_BATCH];
+        ULONG count = 0;
+        uint64_t waitBeginNs = MailslotStatsReadBegin();
+        BOOL waited = GetQueuedCompletionStatusEx(loop.port, entries, EVENT_BATCH, &count,
+                                                  waitMs < 0 ? INFINITE : (DWORD)waitMs, FALSE);
+        MailslotStatsWaitEnd(waitBeginNs);
+        if (!waited) {
+            if (GetLastError() == WAIT_TIMEOUT) continue;
+            return false;
+        }
+        for (ULONG i = 0; i < count; i++) {
+            MailslotLoopSlot& slot = *loop.slots[(size_t)entries[i].lpCompletionKey];
+            if (!slot.open) continue;             // cancelled read of a closed slot
+            DWORD bytesRead = 0;
+            if (GetOverlappedResult(slot.server.handle, &slot.overlapped, &bytesRead, FALSE)) {
+                MailslotStatsMessage(bytesRead);
+                MailslotLoopDispatch(slot, slot.buffer.data(), bytesRead);
+            } else {
+                MailslotStatsError(GetLastError());
+                HandleMailslotError("ReadFile");
+            }
+            if (slot.open && !MailslotLoopArmRead(slot)) {
+                HandleMailslotError("ReadFile");
+                MailslotLoopCloseSlot(loop, slot);
+            }
+        }
+#else
+        epoll_event events[EVENT_BATCH];
+        uint64_t waitBeginNs = MailslotStatsReadBegin();
+        int count = epoll_wait(loop.epollFd, events, EVENT_BATCH, waitMs);
+        MailslotStatsWaitEnd(waitBeginNs);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        for (int i = 0; i < count; i++) {
+            MailslotLoopSlot& slot = *loop.slots[events[i].data.u32];
+            if (!slot.open) continue;
+            // One batch per ready slot, then move on (level-triggered)
+            uint32_t received = 0;
+            if (!MailslotReceiveMany(slot.server, loop.batch, MAILSLOT_BATCH_MAX, &received, 0)) {
+                if (errno != MAILSLOT_ERROR_TIMEOUT) HandleMailslotError("ReadFile");
+                continue;
+            }
+            for (uint32_t n = 0; n < received && slot.open; n++) {
+                MailslotLoopDispatch(slot, loop.batch[n].buffer, loop.batch[n].length);
+            }
+        }
+#endif
+    }
+    return true;
+}
+
+inline void MailslotLoopStop(MailslotEventLoop& loop) {
+    loop.stopped = true;
+}
+
+inline void MailslotLoopClose(MailslotEventLoop& loop) {
+    for (size_t i = 0; i < loop.slots.size(); i++) {
+        MailslotLoopCloseSlot(loop, *loop.slots[i]);
+    }
+#ifdef _WIN32
+    if (loop.port != NULL) CloseHandle(loop.port);
+    loop.port = NULL;
+#else
+    if (loop.epollFd >= 0) close(loop.epollFd);
+    loop.epollFd = -1;
+#endif
+}
@@ -0,0 +1,298 @@
+#pragma once
+
+// ------------------------------
+// MailslotFragment: large messages over bounded-size slots
+// A message larger than one datagram is split into numbered fragments,
+// each a binary frame (MailslotFrame.h) with MAILSLOT_FRAME_FLAG_FRAGMENT
+// and a 16-byte header extension:
+//
+//   off  size  field
+//    0    4    messageId      per sender, +1 per large message
+//    4    4    totalLength    bytes of the whole message
+//    8    4    offset         where this fragment's payload goes
+//   12    2    index          0 .. count-1
+//   14    2    count          fragments in the message
+//
+// With a 300-byte slot each fragment carries 252 payload bytes, so one
+// message can be up to 65535 fragments (about 16 MB).
+//
+// The receiver (MailslotReassembler) keeps messages in progress in a fixed
+// table keyed by (sender id, message id) — fragments may arrive interleaved
+// when several workers process them — and copies each fragment straight
+// into a pooled buffer of the right size class. Incomplete messages are evicted after a
+// timeout; the pools are the memory cap — size classes that do not fit in
+// it are left out, and when no buffer is free the message is dropped and
+// counted. Datagrams are not duplicated by the
+// transport, so fragments are counted rather than tracked in a bitmap.
+// ------------------------------
+
+#include "MailslotBatch.h"
+#include "MailslotFrame.h"
+#include "MailslotPool.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+struct MailslotFragmentHeader {
+    uint32_t messageId;
+    uint32_t totalLength;
+    uint32_t offset;
+    uint16_t index;
+    uint16_t count;
+};
+static_assert(sizeof(MailslotFragmentHeader) == 16, "fragment header layout");
+
+static const uint32_t kFragmentMaxCount = 0xFFFF;
+
+inline bool MailslotIsFragment(const MailslotFrameView& frame) {
+    return (frame.header->flags & MAILSLOT_FRAME_FLAG_FRAGMENT) != 0 &&
+           frame.extensionLength >= sizeof(MailslotFragmentHeader);
+}
+
+// ------------------------------
+// Send side
+// ------------------------------
+struct MailslotFragmentWriter {
+    uint32_t senderId = 0;
+    uint32_t sequence = 0;                // frame sequence (every datagram)
+    uint32_t messageId = 0;               // large messages
+    uint32_t deadlineMs = 0;              // frames expire deadlineMs after they are queued (0 — never)
+    std::vector<char> scratch;            // one frame
+    uint64_t fragments = 0;               // fragment frames queued
+};
+
+inline void MailslotFragmentWriterInit(MailslotFragmentWriter& writer, uint32_t maxFrameSize,
+                                       uint32_t senderId = MailslotFrameSenderId()) {
+    writer.senderId = senderId;
+    writer.sequence = 0;
+    writer.messageId = 0;
+    writer.scratch.assign(maxFrameSize, 0);
+    writer.fragments = 0;
+}
+
+// Largest frame one datagram of the batch sender carries
+inline uint32_t MailslotFragmentFrameSize(const MailslotFragmentWriter& writer, const MailslotBatchSender& batch) {
+    uint32_t frameSize = batch.maxFrameSize;
+    if (batch.coalesce) frameSize -= kCoalescedHeaderSize + kCoalescedEntryHeader;
+    return std::min(frameSize, (uint32_t)writer.scratch.size());
+}
+
+// Queue one message of any size on a batch sender: a single frame when it
+// fits, numbered fragments otherwise. Fails with
+// MAILSLOT_ERROR_INSUFFICIENT_BUFFER when it needs more than 65535 fragments;
+// send errors are counted by the batch sender.
+inline bool MailslotFragmentSend(MailslotFragmentWriter& writer, MailslotBatchSender& batch,
+                                 const char* data, uint32_t length) {
+    uint32_t frameSize = MailslotFragmentFrameSize(writer, batch);
+    char* frame = writer.scratch.data();
+
+    // Block 1: small message — one plain frame (plus the optional deadline)
+    const uint16_t deadline = MailslotFrameDeadlineSize(writer.deadlineMs);
+    if (length + sizeof(MailslotFrameHeader) + deadline <= frameSize) {
+        memcpy(MailslotFramePayload(frame, deadline), data, length);
+        uint8_t flags = MailslotFrameSetDeadline(frame, deadline, writer.deadlineMs);
+        return MailslotBatchAdd(batch, frame,
+                                MailslotFrameSeal(frame, writer.senderId, writer.sequence++, length, 0, flags, deadline));
+    }
+
+    // Block 2: split into fragments of chunk bytes; all share one deadline
+    // (a frame must hold header + extension + at least one payload byte)
+    const uint16_t extension = sizeof(MailslotFragmentHeader) + deadline;
+    if (frameSize <= sizeof(MailslotFrameHeader) + extension) {
+        MailslotSetLastError(MAILSLOT_ERROR_INSUFFICIENT_BUFFER);
+        return false;
+    }
+    uint32_t chunk = frameSize - sizeof(MailslotFrameHeader) - extension;
+    uint64_t count = ((uint64_t)length + chunk - 1) / chunk;
+    if (count > kFragmentMaxCount) {
+        MailslotSetLastError(MAILSLOT_ERROR_INSUFFICIENT_BUFFER);
+        return false;
+    }
+    MailslotFragmentHeader* fragment = (MailslotFragmentHeader*)(frame + sizeof(MailslotFrameHeader));
+    fragment->messageId = writer.messageId++;
+    fragment->totalLength = length;
+    fragment->count = (uint16_t)count;
+    uint8_t flags = MAILSLOT_FRAME_FLAG_FRAGMENT | MailslotFrameSetDeadline(frame, extension, writer.deadlineMs);
+    bool ok = true;
+    for (uint32_t index = 0; index < count; index++) {
+        uint32_t offset = index * chunk;
+        uint32_t piece = std::min(chunk, length - offset);
+        fragment->offset = offset;
+        fragment->index = (uint16_t)index;
+        memcpy(MailslotFramePayload(frame, extension), data + offset, piece);
+        uint32_t total = MailslotFrameSeal(frame, writer.senderId, writer.sequence++, piece, 0, flags, extension);
+        ok = MailslotBatchAdd(batch, frame, total) && ok;
+        writer.fragments++;
+    }
+    return ok;
+}
+
+// ------------------------------
+// Receive side
+// ------------------------------
+enum MailslotReassemblyResult {
+    MAILSLOT_REASSEMBLY_PENDING,          // fragment stored, message incomplete
+    MAILSLOT_REASSEMBLY_COMPLETE,         // whole message returned
+    MAILSLOT_REASSEMBLY_DROPPED           // fragment discarded (see counters)
+};
+
+struct MailslotReassemblyConfig {
+    uint32_t maxMessage = 16u << 20;      // largest message accepted
+    uint64_t memoryCap = 64ull << 20;     // bytes of reassembly buffers (all size classes)
+    uint32_t timeoutMs = 2000;            // evict incomplete messages after this
+    uint32_t inProgress = 256;            // messages being reassembled at once
+};
+
+struct MailslotReassembler {
+    struct Entry {
+        uint32_t senderId;
+        uint32_t messageId;
+        uint32_t used;
+        uint32_t dropping;                // buffer unavailable: ignore the rest
+        uint32_t fragments;               // received so far
+        uint32_t count;
+        uint32_t totalLength;
+        uint64_t startNs;
+        MailslotMessageView buffer;
+    };
+
+    MailslotReassemblyConfig config;
+    std::vector<std::unique_ptr<MailslotPool>> pools;  // size classes 4 KB, 64 KB, 1 MB, ...
+    std::vector<Entry> entries;
+    uint64_t lastSweepNs = 0;
+
+    uint64_t fragments = 0;               // fragments accepted
+    uint64_t messages = 0;                // messages completed
+    uint64_t bytes = 0;                   // bytes of completed messages
+    uint64_t expired = 0;                 // incomplete messages evicted on timeout
+    uint64_t overflow = 0;                // messages dropped: no buffer within the memory cap
+    uint64_t invalid = 0;                 // inconsistent or oversized fragments
+    uint64_t tableFull = 0;               // fragments of messages beyond the table
+};
+
+inline void MailslotReassemblerInit(MailslotReassembler& reassembler, const MailslotReassemblyConfig& config) {
+    reassembler.config = config;
+    reassembler.pools.clear();
+    std::vector<uint32_t> classes;
+    for (uint64_t size = 4096;; size *= 16) {
+        classes.push_back((uint32_t)std::min<uint64_t>(size, config.maxMessage));
+        if (size >= config.maxMessage) break;
+    }
+    // The cap is shared evenly among the classes; a class whose buffer does
+    // not fit in its share is dropped (largest first) and its share goes to
+    // the rest — messages only it could hold are counted as overflow
+    while (!classes.empty() && config.memoryCap / classes.size() < classes.back()) classes.pop_back();
+    for (uint32_t size : classes) {
+        uint32_t blocks = (uint32_t)(config.memoryCap / classes.size() / size);
+        reassembler.pools.emplace_back(new MailslotPool(blocks, size));
+    }
+    reassembler.entries.clear();
+    reassembler.entries.resize(config.inProgress == 0 ? 1 : config.inProgress);
+    reassembler.lastSweepNs = MailslotNowNs();
+}
+
+// Smallest free buffer that holds length bytes (falls back to larger classes)
+inline MailslotMessageView MailslotReassemblerBuffer(MailslotReassembler& reassembler, uint32_t length) {
+    for (auto& pool : reassembler.pools) {
+        if (pool->Capacity() < length) continue;
+        MailslotMessageView view = MailslotPoolAcquire(*pool);
+        if (view) return view;
+    }
+    return MailslotMessageView();
+}
+
+// Evict messages older than the timeout; returns how many were evicted
+inline uint32_t MailslotReassemblerExpire(MailslotReassembler& reassembler, uint64_t nowNs) {
+    uint64_t timeoutNs = (uint64_t)reassembler.config.timeoutMs * 1000000ull;
+    uint32_t evicted = 0;
+    for (auto& entry : reassembler.entries) {
+        if (entry.used && nowNs - entry.startNs > timeoutNs) {
+            if (!entry.dropping) {
+                reassembler.expired++;
+                evicted++;
+            }
+            entry.buffer.Reset();
+            entry.used = 0;
+        }
+    }
+    reassembler.lastSweepNs = nowNs;
+    return evicted;
+}
+
+// Messages still in progress (e.g. to report at shutdown)
+inline uint32_t MailslotReassemblerPending(const MailslotReassembler& reassembler) {
+    uint32_t pending = 0;
+    for (const auto& entry : reassembler.entries) pending += entry.used && !entry.dropping;
+    return pending;
+}
+
+// Store one fragment frame. On COMPLETE *message holds the whole message
+// (a pooled buffer; release it by dropping the view).
+inline MailslotReassemblyResult MailslotReassemblerAdd(MailslotReassembler& reassembler,
+                                                       const MailslotFrameView& frame,
+                                                       MailslotMessageView* message) {
+    MailslotFragmentHeader fragment;
+    memcpy(&fragment, frame.extension, sizeof(fragment));
+    uint64_t nowNs = MailslotNowNs();
+    if (nowNs - reassembler.lastSweepNs > (uint64_t)reassembler.config.timeoutMs * 250000ull) {
+        MailslotReassemblerExpire(reassembler, nowNs);       // every quarter timeout
+    }
+    if (fragment.count == 0 || fragment.index >= fragment.count ||
+        fragment.totalLength > reassembler.config.maxMessage ||
+        (uint64_t)fragment.offset + frame.payloadLength > fragment.totalLength) {
+        reassembler.invalid++;
+        return MAILSLOT_REASSEMBLY_DROPPED;
+    }
+
+    // Block 1: find the message's entry (open addressing; freed slots do
+    // not end a probe, so the whole chain is searched)
+    uint32_t senderId = frame.header->senderId;
+    uint32_t size = (uint32_t)reassembler.entries.size();
+    uint32_t slot = ((senderId ^ (fragment.messageId * 0x9E3779B9u)) * 2654435761u) % size;
+    MailslotReassembler::Entry* entry = nullptr;
+    MailslotReassembler::Entry* empty = nullptr;
+    for (uint32_t probe = 0; probe < size; probe++) {
+        MailslotReassembler::Entry& candidate = reassembler.entries[(slot + probe) % size];
+        if (candidate.used && candidate.senderId == senderId && candidate.messageId == fragment.messageId) {
+            entry = &candidate;
+            break;
+        }
+        if (!candidate.used && empty == nullptr) empty = &candidate;
+    }
+
+    // Block 2: first fragment seen — take a slot and a buffer
+    if (entry == nullptr) {
+        entry = empty;
+        if (entry == nullptr) {
+            reassembler.tableFull++;
+            return MAILSLOT_REASSEMBLY_DROPPED;
+        }
+        entry->senderId = senderId;
+        entry->messageId = fragment.messageId;
+        entry->used = 1;
+        entry->fragments = 0;
+        entry->count = fragment.count;
+        entry->totalLength = fragment.totalLength;
+        entry->startNs = nowNs;
+        entry->buffer = MailslotReassemblerBuffer(reassembler, fragment.totalLength);
+        entry->dropping = entry->buffer ? 0 : 1;
+        if (entry->dropping) reassembler.overflow++;
+    }
+    if (entry->dropping) return MAILSLOT_REASSEMBLY_DROPPED;
+    if (entry->count != fragment.count || entry->totalLength != fragment.totalLength) {
+        reassembler.invalid++;
+        return MAILSLOT_REASSEMBLY_DROPPED;
+    }
+
+    // Block 3: copy the piece into place; the last one completes the message
+    memcpy(entry->buffer.Data() + fragment.offset, frame.payload, frame.payloadLength);
+    reassembler.fragments++;
+    if (++entry->fragments < entry->count) return MAILSLOT_REASSEMBLY_PENDING;
+    entry->buffer.SetLength(entry->totalLength);
+    *message = std::move(entry->buffer);
+    entry->buffer.Reset();
+    entry->used = 0;
+    reassembler.messages++;
+    reassembler.bytes += entry->totalLength;
+    return MAILSLOT_REASSEMBLY_COMPLETE;
+}
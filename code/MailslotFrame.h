@@ -0,0 +1,334 @@
+#pragma once
+
+// ------------------------------
+// MailslotFrame: binary message framing with CRC32C
+// A framed message is a fixed 32-byte little-endian header, optional
+// extension bytes, then the payload (any bytes, not a C string):
+//
+//   off  size  field
+//    0    2    magic          01 'M' — never starts a text message or a
+//                             coalesced frame (00 'M' 'S' 'C')
+//    2    1    version        1
+//    3    1    flags          MAILSLOT_FRAME_FLAG_*
+//    4    2    type           application-defined
+//    6    2    headerLength   32 + extension bytes
+//    8    4    senderId       e.g. process id
+//   12    4    sequence       per sender, +1 per message
+//   16    8    timestampNs    MailslotNowNs at the sender
+//   24    4    payloadLength
+//   28    4    crc32c         over bytes 0..27 and headerLength.. the end
+//
+// Encoding is in place: write the payload at MailslotFramePayload(buffer),
+// then MailslotFrameSeal fills the header in front of it. Decoding returns
+// pointers into the receive buffer (no copy); the header is read in place,
+// which needs a target with unaligned loads (x86, ARMv8).
+// CRC32C uses SSE4.2 (runtime check) or the ARMv8 CRC instructions
+// (when the compiler targets them), otherwise a slicing-by-8 table.
+// ------------------------------
+
+#include "MailslotPlatform.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MAILSLOT_CRC32C_SSE42 1
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__ARM_FEATURE_CRC32)
+#define MAILSLOT_CRC32C_ARMV8 1
+#include <arm_acle.h>
+#endif
+
+// ------------------------------
+// CRC32C (Castagnoli)
+// ------------------------------
+
+// Slicing-by-8 tables, built once
+inline const uint32_t (*MailslotCrc32cTable())[256] {
+    static uint32_t table[8][256];
+    static bool ready = [] {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1)));
+            table[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int slice = 1; slice < 8; slice++) {
+                table[slice][i] = (table[slice - 1][i] >> 8) ^ table[0][table[slice - 1][i] & 0xFF];
+            }
+        }
+        return true;
+    }();
+    (void)ready;
+    return table;
+}
+
+inline uint32_t MailslotCrc32cSoftware(uint32_t crc, const char* data, size_t length) {
+    const uint32_t (*table)[256] = MailslotCrc32cTable();
+    while (length >= 8) {
+        uint32_t low, high;
+        memcpy(&low, data, 4);
+        memcpy(&high, data + 4, 4);
+        low ^= crc;
+        crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^ table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+              table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^ table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+        data += 8;
+        length -= 8;
+    }
+    while (length-- > 0) crc = (crc >> 8) ^ table[0][(crc ^ (uint8_t)*data++) & 0xFF];
+    return crc;
+}
+
+#if defined(MAILSLOT_CRC32C_SSE42)
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((target("sse4.2")))
+#endif
+inline uint32_t MailslotCrc32cHardware(uint32_t crc, const char* data, size_t length) {
+    uint64_t crc64 = crc;
+    while (length >= 8) {
+        uint64_t value;
+        memcpy(&value, data, 8);
+        crc64 = _mm_crc32_u64(crc64, value);
+        data += 8;
+        length -= 8;
+    }
+    crc = (uint32_t)crc64;
+    while (length-- > 0) crc = _mm_crc32_u8(crc, (uint8_t)*data++);
+    return crc;
+}
+
+inline bool MailslotCrc32cHardwareAvailable() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+#elif defined(MAILSLOT_CRC32C_ARMV8)
+inline uint32_t MailslotCrc32cHardware(uint32_t crc, const char* data, size_t length) {
+    while (length >= 8) {
+        uint64_t value;
+        memcpy(&value, data, 8);
+        crc = __crc32cd(crc, value);
+        data += 8;
+        length -= 8;
+    }
+    while (length-- > 0) crc = __crc32cb(crc, (uint8_t)*data++);
+    return crc;
+}
+
+inline bool MailslotCrc32cHardwareAvailable() { return true; }
+#endif
+
+// Continue a CRC32C: pass 0 to start, or a previous result to extend it
+inline uint32_t MailslotCrc32c(const void* data, size_t length, uint32_t crc = 0) {
+#if defined(MAILSLOT_CRC32C_SSE42) || defined(MAILSLOT_CRC32C_ARMV8)
+    static const bool hardware = MailslotCrc32cHardwareAvailable();
+    if (hardware) return ~MailslotCrc32cHardware(~crc, (const char*)data, length);
+#endif
+    return ~MailslotCrc32cSoftware(~crc, (const char*)data, length);
+}
+
+// ------------------------------
+// Frame header
+// ------------------------------
+static const uint16_t kFrameMagic = 0x4D01;          // bytes 01 'M'
+static const uint8_t  kFrameVersion = 1;
+static const uint32_t kFrameCrcOffset = 28;
+
+// Header flags
+static const uint8_t MAILSLOT_FRAME_FLAG_FRAGMENT = 0x01;   // part of a larger message (MailslotFragment.h)
+static const uint8_t MAILSLOT_FRAME_FLAG_COMPRESSED = 0x02; // payload compressed (MailslotCompress.h)
+static const uint8_t MAILSLOT_FRAME_FLAG_DEADLINE = 0x04;   // extension ends with a deadline (see below)
+
+struct MailslotFrameHeader {
+    uint16_t magic;
+    uint8_t  version;
+    uint8_t  flags;
+    uint16_t type;
+    uint16_t headerLength;
+    uint32_t senderId;
+    uint32_t sequence;
+    uint64_t timestampNs;
+    uint32_t payloadLength;
+    uint32_t crc32c;
+};
+static_assert(sizeof(MailslotFrameHeader) == 32, "frame header layout");
+
+enum MailslotFrameStatus {
+    MAILSLOT_FRAME_OK,
+    MAILSLOT_FRAME_NOT_FRAMED,            // plain message (no magic)
+    MAILSLOT_FRAME_TRUNCATED,             // shorter than its header says
+    MAILSLOT_FRAME_BAD_VERSION,
+    MAILSLOT_FRAME_BAD_CHECKSUM
+};
+
+// Decoded frame: pointers into the receive buffer
+struct MailslotFrameView {
+    const MailslotFrameHeader* header = nullptr;
+    const char* extension = nullptr;      // headerLength - 32 bytes
+    uint32_t extensionLength = 0;
+    const char* payload = nullptr;
+    uint32_t payloadLength = 0;
+};
+
+// Sender id for frames from this process
+inline uint32_t MailslotFrameSenderId() {
+#ifdef _WIN32
+    return (uint32_t)GetCurrentProcessId();
+#else
+    return (uint32_t)getpid();
+#endif
+}
+
+// Where the payload goes for a frame with extensionLength extension bytes
+// (the extension itself starts at buffer + sizeof(MailslotFrameHeader))
+inline char* MailslotFramePayload(char* buffer, uint16_t extensionLength = 0) {
+    return buffer + sizeof(MailslotFrameHeader) + extensionLength;
+}
+
+// Fill the header in front of a payload (and extension) already in buffer;
+// returns the total frame length
+inline uint32_t MailslotFrameSeal(char* buffer, uint32_t senderId, uint32_t sequence, uint32_t payloadLength,
+                                  uint16_t type = 0, uint8_t flags = 0, uint16_t extensionLength = 0) {
+    MailslotFrameHeader* header = (MailslotFrameHeader*)buffer;
+    header->magic = kFrameMagic;
+    header->version = kFrameVersion;
+    header->flags = flags;
+    header->type = type;
+    header->headerLength = (uint16_t)(sizeof(MailslotFrameHeader) + extensionLength);
+    header->senderId = senderId;
+    header->sequence = sequence;
+    header->timestampNs = MailslotNowNs();
+    header->payloadLength = payloadLength;
+    uint32_t total = header->headerLength + payloadLength;
+    uint32_t crc = MailslotCrc32c(buffer, kFrameCrcOffset);
+    header->crc32c = MailslotCrc32c(buffer + sizeof(MailslotFrameHeader), total - sizeof(MailslotFrameHeader), crc);
+    return total;
+}
+
+// ------------------------------
+// Deadline extension (MAILSLOT_FRAME_FLAG_DEADLINE)
+// The last 8 bytes of the extension hold the MailslotNowNs time after which
+// the message is worthless; other extensions (fragment, compression) stay at
+// the front, so any frame can carry one. MailslotNowNs is a monotonic clock
+// shared by the processes of one host — deadlines are for same-host senders.
+// ------------------------------
+static const uint16_t kFrameDeadlineSize = 8;
+
+// Extension bytes needed for an optional deadline (0 — no deadline)
+inline uint16_t MailslotFrameDeadlineSize(uint32_t deadlineMs) {
+    return deadlineMs != 0 ? kFrameDeadlineSize : 0;
+}
+
+// Write the deadline (now + deadlineMs) at the end of an extension of
+// extensionLength bytes, before MailslotFrameSeal; returns the flag to seal
+// with (0 when deadlineMs is 0)
+inline uint8_t MailslotFrameSetDeadline(char* buffer, uint16_t extensionLength, uint32_t deadlineMs) {
+    if (deadlineMs == 0) return 0;
+    uint64_t deadlineNs = MailslotNowNs() + (uint64_t)deadlineMs * 1000000ULL;
+    memcpy(buffer + sizeof(MailslotFrameHeader) + extensionLength - kFrameDeadlineSize, &deadlineNs, sizeof(deadlineNs));
+    return MAILSLOT_FRAME_FLAG_DEADLINE;
+}
+
+inline bool MailslotIsFramed(const char* data, uint32_t length) {
+    uint16_t magic;
+    if (length < sizeof(magic)) return false;
+    memcpy(&magic, data, sizeof(magic));
+    return magic == kFrameMagic;
+}
+
+// Validate a received frame in place; verify = false skips the CRC
+// (e.g. when it was already checked on the receive thread)
+inline MailslotFrameStatus MailslotFrameDecode(const char* data, uint32_t length, MailslotFrameView* view,
+                                               bool verify = true) {
+    if (!MailslotIsFramed(data, length)) return MAILSLOT_FRAME_NOT_FRAMED;
+    if (length < sizeof(MailslotFrameHeader)) return MAILSLOT_FRAME_TRUNCATED;
+    const MailslotFrameHeader* header = (const MailslotFrameHeader*)data;
+    if (header->version != kFrameVersion || header->headerLength < sizeof(MailslotFrameHeader)) {
+        return MAILSLOT_FRAME_BAD_VERSION;
+    }
+    if ((uint64_t)header->headerLength + header->payloadLength != length) return MAILSLOT_FRAME_TRUNCATED;
+    if (verify) {
+        uint32_t crc = MailslotCrc32c(data, kFrameCrcOffset);
+        crc = MailslotCrc32c(data + sizeof(MailslotFrameHeader), length - sizeof(MailslotFrameHeader), crc);
+        if (crc != header->crc32c) return MAILSLOT_FRAME_BAD_CHECKSUM;
+    }
+    view->header = header;
+    view->extension = data + sizeof(MailslotFrameHeader);
+    view->extensionLength = header->headerLength - (uint32_t)sizeof(MailslotFrameHeader);
+    view->payload = data + header->headerLength;
+    view->payloadLength = header->payloadLength;
+    return MAILSLOT_FRAME_OK;
+}
+
+// Deadline of a decoded frame, 0 when it has none
+inline uint64_t MailslotFrameDeadline(const MailslotFrameView& frame) {
+    if ((frame.header->flags & MAILSLOT_FRAME_FLAG_DEADLINE) == 0 || frame.extensionLength < kFrameDeadlineSize) {
+        return 0;
+    }
+    uint64_t deadlineNs;
+    memcpy(&deadlineNs, frame.extension + frame.extensionLength - kFrameDeadlineSize, sizeof(deadlineNs));
+    return deadlineNs;
+}
+
+// True when the frame carries a deadline that passed before nowNs
+inline bool MailslotFrameExpired(const MailslotFrameView& frame, uint64_t nowNs) {
+    uint64_t deadlineNs = MailslotFrameDeadline(frame);
+    return deadlineNs != 0 && nowNs > deadlineNs;
+}
+
+// ------------------------------
+// Loss / reorder detection per sender (no allocation, no syscalls)
+// A gap in a sender's sequence counts as lost; a message arriving after a
+// higher sequence counts as reordered and fills one lost slot again.
+// ------------------------------
+static const uint32_t kSequenceSenders = 1024;       // tracked senders (open addressing)
+
+struct MailslotSequenceTracker {
+    struct Entry {
+        uint32_t senderId;
+        uint32_t used;
+        uint32_t expected;                // next in-order sequence
+    };
+    Entry entries[kSequenceSenders];
+    uint64_t frames;
+    uint64_t lost;
+    uint64_t reordered;
+    uint64_t senders;
+    uint64_t untracked;                   // frames from senders beyond the table
+};
+
+inline void MailslotSequenceReset(MailslotSequenceTracker& tracker) {
+    memset(&tracker, 0, sizeof(tracker));
+}
+
+inline void MailslotSequenceTrack(MailslotSequenceTracker& tracker, uint32_t senderId, uint32_t sequence) {
+    tracker.frames++;
+    uint32_t slot = (senderId * 2654435761u) % kSequenceSenders;
+    for (uint32_t probe = 0; probe < kSequenceSenders; probe++) {
+        MailslotSequenceTracker::Entry& entry = tracker.entries[(slot + probe) % kSequenceSenders];
+        if (!entry.used) {                // first frame of this sender is the baseline
+            entry.used = 1;
+            entry.senderId = senderId;
+            entry.expected = sequence + 1;
+            tracker.senders++;
+            return;
+        }
+        if (entry.senderId != senderId) continue;
+        int32_t ahead = (int32_t)(sequence - entry.expected);   // wrap-safe
+        if (ahead >= 0) {
+            tracker.lost += (uint32_t)ahead;
+            entry.expected = sequence + 1;
+        } else {
+            tracker.reordered++;
+            if (tracker.lost > 0) tracker.lost--;
+        }
+        return;
+    }
+    tracker.untracked++;
+}
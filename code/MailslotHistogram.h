@@ -0,0 +1,81 @@
+#pragma once
+
+// ------------------------------
+// MailslotHistogram: HDR-style log-linear latency histogram
+// Values below 128 are exact; above that every power of two is split into
+// 64 sub-buckets, so any recorded value is reported within 1/64 (~1.6%).
+// Fixed size, no allocation; recording is a couple of shifts and an add.
+// ------------------------------
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+static const int kHistogramSubBuckets = 64;                      // per power of two
+static const int kHistogramBuckets = 128 + 57 * kHistogramSubBuckets; // full uint64_t range
+
+struct MailslotHistogram {
+    uint64_t counts[kHistogramBuckets];
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    double sum;
+};
+
+inline void MailslotHistogramReset(MailslotHistogram& histogram) {
+    memset(histogram.counts, 0, sizeof(histogram.counts));
+    histogram.total = 0;
+    histogram.min = UINT64_MAX;
+    histogram.max = 0;
+    histogram.sum = 0;
+}
+
+inline int MailslotHistogramIndex(uint64_t value) {
+    if (value < 128) return (int)value;
+    int msb = 63;
+    while ((value >> msb) == 0) msb--;
+    int shift = msb - 6;                                         // keep the top 7 bits
+    return 128 + (shift - 1) * kHistogramSubBuckets + (int)((value >> shift) - kHistogramSubBuckets);
+}
+
+// Highest value that maps to a bucket
+inline uint64_t MailslotHistogramValue(int index) {
+    if (index < 128) return (uint64_t)index;
+    int shift = (index - 128) / kHistogramSubBuckets + 1;
+    uint64_t top = (uint64_t)((index - 128) % kHistogramSubBuckets + kHistogramSubBuckets);
+    return ((top + 1) << shift) - 1;
+}
+
+inline void MailslotHistogramRecord(MailslotHistogram& histogram, uint64_t value) {
+    histogram.counts[MailslotHistogramIndex(value)]++;
+    histogram.total++;
+    histogram.sum += (double)value;
+    if (value < histogram.min) histogram.min = value;
+    if (value > histogram.max) histogram.max = value;
+}
+
+inline void MailslotHistogramMerge(MailslotHistogram& into, const MailslotHistogram& from) {
+    for (int i = 0; i < kHistogramBuckets; i++) into.counts[i] += from.counts[i];
+    into.total += from.total;
+    into.sum += from.sum;
+    into.min = std::min(into.min, from.min);
+    into.max = std::max(into.max, from.max);
+}
+
+// Value at percentile (0..100); the exact max for 100
+inline uint64_t MailslotHistogramPercentile(const MailslotHistogram& histogram, double percentile) {
+    if (histogram.total == 0) return 0;
+    if (percentile >= 100.0) return histogram.max;
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)histogram.total + 0.5);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < kHistogramBuckets; i++) {
+        seen += histogram.counts[i];
+        if (seen >= rank) return std::min(MailslotHistogramValue(i), histogram.max);
+    }
+    return histogram.max;
+}
+
+inline double MailslotHistogramMean(const MailslotHistogram& histogram) {
+    return histogram.total == 0 ? 0.0 : histogram.sum / (double)histogram.total;
+}
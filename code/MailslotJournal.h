@@ -0,0 +1,453 @@
+#pragma once
+
+// ------------------------------
+// MailslotJournal: persistent journal of received messages
+// Every message is appended to a preallocated, memory-mapped segment file:
+//   <directory>/mailslot-00000001.journal, -00000002, ...
+// A segment is a 64-byte header followed by records
+//   [u32 marker "MSJR"][u32 length][u64 sequence][u64 timestampNs][payload]
+// padded to 8 bytes. The marker is stored last, so a record that was only
+// partly written is never read back. When the next record does not fit,
+// the journal rolls over to a new segment of the same size.
+//
+// Durability:
+// - NONE:     the mapping is the only copy until the OS writes it back;
+//             survives a crash of the process, not of the machine
+// - PERIODIC: a background thread starts write-back (msync MS_ASYNC /
+//             FlushViewOfFile) every syncIntervalMs
+// - GROUP:    group commit — the background thread synchronously flushes
+//             everything appended in the last syncIntervalMs in one call
+//             and publishes the durable sequence; MailslotJournalWaitDurable
+//             blocks until a record is on disk
+//
+// Appends come from one thread (the receive loop). Reopening a directory
+// continues after the last complete record; MailslotJournalReader replays
+// the segments in order.
+// ------------------------------
+
+#include "MailslotPlatform.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static const uint64_t kJournalMagic = 0x31304C4E524A534DULL;  // "MSJRNL01"
+static const uint32_t kJournalRecordMarker = 0x524A534D;       // "MSJR"
+static const uint32_t kJournalHeaderSize = 64;
+
+enum MailslotDurability {
+    MAILSLOT_DURABILITY_NONE,
+    MAILSLOT_DURABILITY_PERIODIC,
+    MAILSLOT_DURABILITY_GROUP
+};
+
+struct MailslotJournalSegmentHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t segmentSize;
+    uint64_t index;                       // 1, 2, ...
+    uint64_t firstSequence;               // sequence of the first record
+    uint8_t reserved[24];
+};
+
+struct MailslotJournalRecordHeader {
+    uint32_t marker;                      // kJournalRecordMarker once complete
+    uint32_t length;                      // payload bytes
+    uint64_t sequence;                    // 1, 2, ... across segments
+    uint64_t timestampNs;                 // MailslotNowNs at append
+};
+
+inline uint64_t MailslotJournalRecordSize(uint32_t length) {
+    return (sizeof(MailslotJournalRecordHeader) + length + 7) & ~(uint64_t)7;
+}
+
+// ------------------------------
+// Mapped segment file
+// ------------------------------
+struct MailslotMappedFile {
+    char* base = nullptr;
+    uint64_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#else
+    int fd = -1;
+#endif
+};
+
+// Map a whole file; create (and preallocate to size) when create is set,
+// otherwise map the existing file (read-only unless writable)
+inline bool MailslotMapFile(MailslotMappedFile& mapped, const std::string& path, uint64_t size, bool create,
+                            bool writable = true) {
+    writable = writable || create;
+#ifdef _WIN32
+    mapped.file = CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                              writable ? FILE_SHARE_READ : FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                              create ? CREATE_NEW : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (mapped.file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (create) {
+        fileSize.QuadPart = (LONGLONG)size;
+        if (!SetFilePointerEx(mapped.file, fileSize, NULL, FILE_BEGIN) || !SetEndOfFile(mapped.file)) {
+            DWORD error = GetLastError();
+            CloseHandle(mapped.file);
+            SetLastError(error);
+            return false;
+        }
+    } else {
+        GetFileSizeEx(mapped.file, &fileSize);
+        size = (uint64_t)fileSize.QuadPart;
+    }
+    mapped.mapping = CreateFileMappingA(mapped.file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+    mapped.base = mapped.mapping
+        ? (char*)MapViewOfFile(mapped.mapping, writable ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (mapped.base == nullptr) {
+        DWORD error = GetLastError();
+        if (mapped.mapping) CloseHandle(mapped.mapping);
+        CloseHandle(mapped.file);
+        SetLastError(error);
+        return false;
+    }
+#else
+    mapped.fd = open(path.c_str(), (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC | (create ? O_CREAT | O_EXCL : 0), 0644);
+    if (mapped.fd < 0) return false;
+    if (create) {
+        // Reserve the blocks now so appends never hit ENOSPC through SIGBUS;
+        // plain ftruncate where the file system has no fallocate
+        int error = posix_fallocate(mapped.fd, 0, (off_t)size);
+        if (error != 0 && ftruncate(mapped.fd, (off_t)size) == 0) error = 0;
+        if (error != 0) {
+            close(mapped.fd);
+            unlink(path.c_str());
+            errno = error;
+            return false;
+        }
+    } else {
+        struct stat info;
+        fstat(mapped.fd, &info);
+        size = (uint64_t)info.st_size;
+    }
+    void* base = size > 0 ? mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, mapped.fd, 0)
+                          : MAP_FAILED;
+    if (base == MAP_FAILED) {
+        int error = size > 0 ? errno : MAILSLOT_ERROR_INVALID_PARAMETER;
+        close(mapped.fd);
+        errno = error;
+        return false;
+    }
+    mapped.base = (char*)base;
+#endif
+    mapped.size = size;
+    return true;
+}
+
+// Flush [offset, offset + length) of the mapping; wait — synchronous
+inline bool MailslotSyncFile(MailslotMappedFile& mapped, uint64_t offset, uint64_t length, bool wait) {
+    if (mapped.base == nullptr || length == 0) return true;
+#ifdef _WIN32
+    if (!FlushViewOfFile(mapped.base + offset, (SIZE_T)length)) return false;
+    return !wait || FlushFileBuffers(mapped.file);
+#else
+    uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t start = offset & ~(page - 1);
+    return msync(mapped.base + start, offset + length - start, wait ? MS_SYNC : MS_ASYNC) == 0;
+#endif
+}
+
+inline void MailslotUnmapFile(MailslotMappedFile& mapped) {
+    if (mapped.base == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(mapped.base);
+    CloseHandle(mapped.mapping);
+    CloseHandle(mapped.file);
+#else
+    munmap(mapped.base, mapped.size);
+    close(mapped.fd);
+#endif
+    mapped.base = nullptr;
+    mapped.size = 0;
+}
+
+inline std::string MailslotJournalSegmentPath(const std::string& directory, uint64_t index) {
+    char name[64];
+    snprintf(name, sizeof(name), "mailslot-%08llu.journal", (unsigned long long)index);
+    return directory + "/" + name;
+}
+
+inline bool MailslotJournalSegmentExists(const std::string& directory, uint64_t index) {
+    FILE* file = fopen(MailslotJournalSegmentPath(directory, index).c_str(), "rb");
+    if (file == NULL) return false;
+    fclose(file);
+    return true;
+}
+
+// Complete record at offset, or nullptr (end of data / torn write)
+inline const MailslotJournalRecordHeader* MailslotJournalRecordAt(const MailslotMappedFile& mapped, uint64_t offset) {
+    if (offset + sizeof(MailslotJournalRecordHeader) > mapped.size) return nullptr;
+    const MailslotJournalRecordHeader* record = (const MailslotJournalRecordHeader*)(mapped.base + offset);
+    if (record->marker != kJournalRecordMarker ||
+        offset + MailslotJournalRecordSize(record->length) > mapped.size) {
+        return nullptr;
+    }
+    return record;
+}
+
+// Walk the records of a mapped segment from offset; stops at the first
+// incomplete record. Returns the end offset, *last = last sequence seen.
+inline uint64_t MailslotJournalScan(const MailslotMappedFile& mapped, uint64_t offset, uint64_t* last) {
+    while (const MailslotJournalRecordHeader* record = MailslotJournalRecordAt(mapped, offset)) {
+        *last = record->sequence;
+        offset += MailslotJournalRecordSize(record->length);
+    }
+    return offset;
+}
+
+// ------------------------------
+// Writer
+// ------------------------------
+struct MailslotJournalConfig {
+    std::string directory;                // created when missing (one level)
+    uint64_t segmentSize = 64ull << 20;   // bytes per segment file
+    MailslotDurability durability = MAILSLOT_DURABILITY_NONE;
+    uint32_t syncIntervalMs = 100;        // PERIODIC / GROUP flush period
+};
+
+struct MailslotJournal {
+    MailslotJournalConfig config;
+    MailslotMappedFile segment;
+    uint64_t segmentIndex = 0;
+    uint64_t offset = 0;                  // append position (writer only)
+    uint64_t sequence = 0;                // last appended sequence (writer only)
+
+    // Published by the writer for the flusher (offset stored first, read last)
+    std::atomic<uint64_t> committedOffset{0};
+    std::atomic<uint64_t> committedSequence{0};
+    std::atomic<uint64_t> durableSequence{0};
+    uint64_t syncedOffset = 0;            // flusher, under mutex
+
+    std::atomic<uint64_t> records{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> segments{0};    // rollovers + the first segment
+    std::atomic<uint64_t> syncs{0};
+
+    std::mutex mutex;                     // segment swap vs flush
+    std::condition_variable durable;      // durableSequence advanced
+    std::condition_variable wake;         // flusher timer / stop
+    std::thread flusher;
+    bool stopping = false;
+};
+
+// Flush everything appended since the last flush (mutex held)
+inline bool MailslotJournalFlushLocked(MailslotJournal& journal, bool wait) {
+    uint64_t sequence = journal.committedSequence.load(std::memory_order_acquire);
+    uint64_t offset = journal.committedOffset.load(std::memory_order_acquire);
+    if (offset <= journal.syncedOffset) return true;
+    bool ok = MailslotSyncFile(journal.segment, journal.syncedOffset, offset - journal.syncedOffset, wait);
+    journal.syncs.fetch_add(1, std::memory_order_relaxed);
+    journal.syncedOffset = offset;
+    if (ok && wait) {
+        journal.durableSequence.store(sequence, std::memory_order_release);
+        journal.durable.notify_all();
+    }
+    return ok;
+}
+
+inline void MailslotJournalFlusher(MailslotJournal* journal) {
+    bool wait = journal->config.durability == MAILSLOT_DURABILITY_GROUP;
+    std::unique_lock<std::mutex> lock(journal->mutex);
+    while (!journal->stopping) {
+        journal->wake.wait_for(lock, std::chrono::milliseconds(journal->config.syncIntervalMs));
+        MailslotJournalFlushLocked(*journal, wait);
+    }
+}
+
+// Map segment `index` (create it when missing) and position the writer at its end
+inline bool MailslotJournalMapSegment(MailslotJournal& journal, uint64_t index, bool create) {
+    std::string path = MailslotJournalSegmentPath(journal.config.directory, index);
+    if (!MailslotMapFile(journal.segment, path, journal.config.segmentSize, create)) return false;
+    MailslotJournalSegmentHeader* header = (MailslotJournalSegmentHeader*)journal.segment.base;
+    if (create) {
+        header->version = 1;
+        header->headerSize = kJournalHeaderSize;
+        header->segmentSize = journal.segment.size;
+        header->index = index;
+        header->firstSequence = journal.sequence + 1;
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = kJournalMagic;
+        journal.offset = kJournalHeaderSize;
+    } else {
+        if (journal.segment.size < kJournalHeaderSize || header->magic != kJournalMagic) {
+            MailslotUnmapFile(journal.segment);
+            MailslotSetLastError(MAILSLOT_ERROR_INVALID_PARAMETER);
+            return false;
+        }
+        journal.offset = MailslotJournalScan(journal.segment, kJournalHeaderSize, &journal.sequence);
+    }
+    journal.segmentIndex = index;
+    journal.syncedOffset = create ? 0 : journal.offset;   // a new header is flushed with the first records
+    journal.committedOffset.store(journal.offset, std::memory_order_release);
+    journal.committedSequence.store(journal.sequence, std::memory_order_release);
+    journal.segments.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Open the journal in config.directory, continuing after existing segments
+inline bool MailslotJournalOpen(MailslotJournal& journal, const MailslotJournalConfig& config) {
+    journal.config = config;
+    if (journal.config.segmentSize < 4096) journal.config.segmentSize = 4096;
+    if (journal.config.syncIntervalMs == 0) journal.config.syncIntervalMs = 1;
+    journal.sequence = 0;
+#ifdef _WIN32
+    if (!CreateDirectoryA(journal.config.directory.c_str(), NULL) && GetLastError() != ERROR_ALREADY_EXISTS) return false;
+#else
+    if (mkdir(journal.config.directory.c_str(), 0755) != 0 && errno != EEXIST) return false;
+#endif
+
+    uint64_t last = 0;
+    while (MailslotJournalSegmentExists(journal.config.directory, last + 1)) last++;
+    if (last > 0) {
+        // Sequence numbers continue from the previous run
+        if (!MailslotJournalMapSegment(journal, last, false)) return false;
+    } else if (!MailslotJournalMapSegment(journal, 1, true)) {
+        return false;
+    }
+    journal.durableSequence.store(journal.sequence);
+    journal.stopping = false;
+    if (journal.config.durability != MAILSLOT_DURABILITY_NONE) {
+        journal.flusher = std::thread(MailslotJournalFlusher, &journal);
+    }
+    return true;
+}
+
+// Append one message; *sequence (optional) receives its sequence number.
+// Fails with MAILSLOT_ERROR_INSUFFICIENT_BUFFER when the message cannot fit
+// in an empty segment.
+inline bool MailslotJournalAppend(MailslotJournal& journal, const void* data, uint32_t length,
+                                  uint64_t* sequence = nullptr) {
+    uint64_t recordSize = MailslotJournalRecordSize(length);
+    if (recordSize > journal.config.segmentSize - kJournalHeaderSize) {
+        MailslotSetLastError(MAILSLOT_ERROR_INSUFFICIENT_BUFFER);
+        return false;
+    }
+
+    // Block 1: roll over when the record does not fit
+    if (journal.offset + recordSize > journal.segment.size) {
+        std::lock_guard<std::mutex> lock(journal.mutex);
+        if (journal.config.durability != MAILSLOT_DURABILITY_NONE) {
+            MailslotJournalFlushLocked(journal, journal.config.durability == MAILSLOT_DURABILITY_GROUP);
+        }
+        MailslotUnmapFile(journal.segment);
+        if (!MailslotJournalMapSegment(journal, journal.segmentIndex + 1, true)) return false;
+    }
+
+    // Block 2: payload and header, then the marker that makes the record valid
+    MailslotJournalRecordHeader* record = (MailslotJournalRecordHeader*)(journal.segment.base + journal.offset);
+    record->length = length;
+    record->sequence = ++journal.sequence;
+    record->timestampNs = MailslotNowNs();
+    if (length > 0) memcpy(record + 1, data, length);
+    std::atomic_thread_fence(std::memory_order_release);
+    record->marker = kJournalRecordMarker;
+    journal.offset += recordSize;
+
+    // Block 3: publish for the flusher (offset before sequence, see FlushLocked)
+    journal.committedOffset.store(journal.offset, std::memory_order_release);
+    journal.committedSequence.store(journal.sequence, std::memory_order_release);
+    journal.records.fetch_add(1, std::memory_order_relaxed);
+    journal.bytes.fetch_add(length, std::memory_order_relaxed);
+    if (sequence != nullptr) *sequence = journal.sequence;
+    return true;
+}
+
+// GROUP durability: wait until the record with this sequence is on disk
+// (returns immediately in the other modes)
+inline void MailslotJournalWaitDurable(MailslotJournal& journal, uint64_t sequence) {
+    if (journal.config.durability != MAILSLOT_DURABILITY_GROUP) return;
+    std::unique_lock<std::mutex> lock(journal.mutex);
+    while (journal.durableSequence.load(std::memory_order_acquire) < sequence && !journal.stopping) {
+        journal.durable.wait(lock);
+    }
+}
+
+// Stop the flusher, flush the tail (synchronously unless NONE) and unmap
+inline void MailslotJournalClose(MailslotJournal& journal) {
+    {
+        std::lock_guard<std::mutex> lock(journal.mutex);
+        journal.stopping = true;
+        if (journal.config.durability != MAILSLOT_DURABILITY_NONE) MailslotJournalFlushLocked(journal, true);
+        journal.durable.notify_all();
+        journal.wake.notify_all();
+    }
+    if (journal.flusher.joinable()) journal.flusher.join();
+    MailslotUnmapFile(journal.segment);
+}
+
+// ------------------------------
+// Reader: all records of all segments, in order
+// ------------------------------
+struct MailslotJournalReader {
+    std::string directory;
+    MailslotMappedFile segment;
+    uint64_t segmentIndex = 0;
+    uint64_t offset = 0;
+    uint64_t records = 0;
+};
+
+inline bool MailslotJournalReaderOpenSegment(MailslotJournalReader& reader, uint64_t index) {
+    MailslotUnmapFile(reader.segment);
+    if (!MailslotJournalSegmentExists(reader.directory, index)) return false;
+    if (!MailslotMapFile(reader.segment, MailslotJournalSegmentPath(reader.directory, index), 0, false, false)) {
+        return false;
+    }
+    const MailslotJournalSegmentHeader* header = (const MailslotJournalSegmentHeader*)reader.segment.base;
+    if (reader.segment.size < kJournalHeaderSize || header->magic != kJournalMagic) {
+        MailslotUnmapFile(reader.segment);
+        MailslotSetLastError(MAILSLOT_ERROR_INVALID_PARAMETER);
+        return false;
+    }
+    reader.segmentIndex = index;
+    reader.offset = header->headerSize;
+    return true;
+}
+
+// Fails with MAILSLOT_ERROR_NOT_FOUND when the directory holds no journal
+inline bool MailslotJournalReaderOpen(MailslotJournalReader& reader, const std::string& directory) {
+    reader.directory = directory;
+    reader.records = 0;
+    if (!MailslotJournalSegmentExists(directory, 1)) {
+        MailslotSetLastError(MAILSLOT_ERROR_NOT_FOUND);
+        return false;
+    }
+    return MailslotJournalReaderOpenSegment(reader, 1);
+}
+
+// Next record (pointers stay valid until the next call); false at the end
+inline bool MailslotJournalReaderNext(MailslotJournalReader& reader, const MailslotJournalRecordHeader** header,
+                                      const char** data) {
+    while (reader.segment.base != nullptr) {
+        const MailslotJournalRecordHeader* record = MailslotJournalRecordAt(reader.segment, reader.offset);
+        if (record != nullptr) {
+            *header = record;
+            *data = (const char*)(record + 1);
+            reader.offset += MailslotJournalRecordSize(record->length);
+            reader.records++;
+            return true;
+        }
+        // End of this segment: continue with the next one, if any
+        if (!MailslotJournalReaderOpenSegment(reader, reader.segmentIndex + 1)) break;
+    }
+    return false;
+}
+
+inline void MailslotJournalReaderClose(MailslotJournalReader& reader) {
+    MailslotUnmapFile(reader.segment);
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+// ------------------------------
+// MailslotLog: asynchronous log sink for received messages
+// Receive threads copy fixed-size records into a lock-free bounded ring
+// (MailslotBoundedQueue); one background thread formats them and writes
+// the text in large batches (one fwrite + fflush per batch) to stdout or a
+// file. The receive loop never waits on terminal or disk I/O unless the
+// BLOCK policy is chosen and the ring is full.
+//
+// Full-ring policies:
+// - BLOCK: the writer waits for a free record (nothing is lost)
+// - DROP:  the record is discarded and only counted (MailslotLog::dropped)
+// - COUNT: the record is discarded, and the sink writes a
+//          "... N records dropped" line where the gap is, so the loss is
+//          visible in the output itself
+// ------------------------------
+
+#include "MailslotPipeline.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+static const uint32_t kLogRecordData = 464;  // payload bytes kept per record (512-byte records)
+
+enum MailslotLogPolicy {
+    MAILSLOT_LOG_BLOCK,
+    MAILSLOT_LOG_DROP,
+    MAILSLOT_LOG_COUNT
+};
+
+struct MailslotLogRecord {
+    uint64_t number;                      // caller's sequence (e.g. message counter)
+    uint64_t timestampNs;                 // MailslotNowNs when written
+    uint32_t kind;                        // caller-defined record type
+    uint32_t tag;                         // caller-defined (worker, slot index)
+    uint32_t length;                      // original payload length
+    uint32_t stored;                      // bytes kept in data (<= kLogRecordData)
+    char data[kLogRecordData];
+};
+
+// Format one record into out (at most size bytes); returns the text length
+typedef std::function<int(const MailslotLogRecord& record, char* out, size_t size)> MailslotLogFormatter;
+
+struct MailslotLogConfig {
+    uint32_t records = 8192;              // ring capacity (rounded up to a power of two)
+    MailslotLogPolicy policy = MAILSLOT_LOG_BLOCK;
+    uint32_t batchBytes = 64 * 1024;      // output buffer: written when full or when idle
+    bool prefault = false;                // fault in the ring and the output buffer at open (MailslotStartup.h)
+};
+
+struct MailslotLog {
+    MailslotLogConfig config;
+    MailslotLogFormatter formatter;
+    std::unique_ptr<MailslotBoundedQueue<MailslotLogRecord>> ring;
+    std::unique_ptr<char[]> batch;        // output buffer (batchBytes), used by the sink thread
+    FILE* out = NULL;
+    bool ownsFile = false;
+
+    std::atomic<uint64_t> written{0};     // records formatted and written
+    std::atomic<uint64_t> dropped{0};     // records lost to a full ring
+    std::atomic<uint64_t> unreported{0};  // COUNT: drops not yet reported in the output
+    std::atomic<uint64_t> writes{0};      // fwrite batches
+
+    std::thread thread;
+    std::atomic<bool> stopping{false};
+    std::atomic<int> sleepers{0};         // 1 while the sink is parked
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+};
+
+inline void MailslotLogThread(MailslotLog* log) {
+    std::unique_ptr<char[]>& batch = log->batch;
+    size_t used = 0;
+    const size_t lineMax = kLogRecordData + 256;
+    MailslotLogRecord record;
+    int idle = 0;
+
+    auto flush = [&]() {
+        if (used == 0) return;
+        fwrite(batch.get(), 1, used, log->out);
+        fflush(log->out);
+        log->writes.fetch_add(1, std::memory_order_relaxed);
+        used = 0;
+    };
+
+    while (true) {
+        if (log->ring->TryPop(&record)) {
+            idle = 0;
+            // COUNT: report drops that happened before this record
+            char gapLine[64];
+            size_t gapLength = 0;
+            uint64_t gap = log->unreported.exchange(0, std::memory_order_relaxed);
+            if (gap > 0) {
+                gapLength = (size_t)snprintf(gapLine, sizeof(gapLine), "... %llu records dropped\n",
+                                             (unsigned long long)gap);
+            }
+            // Room for the gap line and the longest formatted line
+            if (used + gapLength + lineMax > log->config.batchBytes) flush();
+            memcpy(batch.get() + used, gapLine, gapLength);
+            used += gapLength;
+            int length = log->formatter(record, batch.get() + used, lineMax);
+            if (length > 0) used += std::min<size_t>((size_t)length, lineMax - 1);
+            log->written.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        // Ring empty: write what we have, then spin briefly and park
+        flush();
+        if (log->stopping.load(std::memory_order_acquire) && log->ring->Size() == 0) break;
+        if (++idle < 64) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(log->sleepMutex);
+        log->sleepers.store(1, std::memory_order_seq_cst);
+        if (log->ring->Size() == 0 && !log->stopping.load(std::memory_order_acquire)) {
+            log->wake.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        log->sleepers.store(0, std::memory_order_relaxed);
+        idle = 0;
+    }
+    uint64_t gap = log->unreported.exchange(0);
+    if (gap > 0) fprintf(log->out, "... %llu records dropped\n", (unsigned long long)gap);
+    fflush(log->out);
+}
+
+// Open the sink: path "" or "-" — stdout, otherwise the file is created
+// (truncated). Returns false (last error set) when the file cannot be opened.
+inline bool MailslotLogOpen(MailslotLog& log, const std::string& path, const MailslotLogConfig& config,
+                            MailslotLogFormatter formatter) {
+    log.config = config;
+    if (log.config.batchBytes < 2 * (kLogRecordData + 256)) log.config.batchBytes = 2 * (kLogRecordData + 256);
+    log.formatter = formatter;
+    if (path.empty() || path == "-") {
+        log.out = stdout;
+        log.ownsFile = false;
+    } else {
+        log.out = fopen(path.c_str(), "wb");
+        if (log.out == NULL) return false;
+        log.ownsFile = true;
+    }
+    log.ring.reset(new MailslotBoundedQueue<MailslotLogRecord>(log.config.records));
+    log.batch.reset(new char[log.config.batchBytes]);
+    if (log.config.prefault) {            // before the sink thread starts using them
+        log.ring->Prefault();
+        MailslotPrefault(log.batch.get(), log.config.batchBytes);
+    }
+    log.stopping.store(false);
+    log.thread = std::thread(MailslotLogThread, &log);
+    return true;
+}
+
+// Queue one record (any thread). Returns false if it was dropped.
+inline bool MailslotLogWrite(MailslotLog& log, uint32_t kind, uint64_t number, uint32_t tag,
+                             const char* data, uint32_t length) {
+    MailslotLogRecord record;
+    record.number = number;
+    record.timestampNs = MailslotNowNs();
+    record.kind = kind;
+    record.tag = tag;
+    record.length = length;
+    record.stored = std::min(length, kLogRecordData);
+    if (record.stored > 0) memcpy(record.data, data, record.stored);
+
+    while (!log.ring->TryPush(record)) {
+        if (log.config.policy != MAILSLOT_LOG_BLOCK) {
+            log.dropped.fetch_add(1, std::memory_order_relaxed);
+            if (log.config.policy == MAILSLOT_LOG_COUNT) log.unreported.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        std::this_thread::yield();        // BLOCK: wait for the sink to catch up
+    }
+    if (log.sleepers.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(log.sleepMutex);
+        log.wake.notify_one();
+    }
+    return true;
+}
+
+// Write out everything queued, stop the sink thread and close the file
+inline void MailslotLogClose(MailslotLog& log) {
+    if (!log.thread.joinable()) return;
+    log.stopping.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(log.sleepMutex);
+        log.wake.notify_all();
+    }
+    log.thread.join();
+    if (log.ownsFile) fclose(log.out);
+    log.out = NULL;
+}
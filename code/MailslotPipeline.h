@@ -0,0 +1,292 @@
+#pragma once
+
+// ------------------------------
+// MailslotPipeline: reader thread + worker pool
+// A dedicated reader drains the slot in batches straight into pooled
+// buffers (MailslotPool) and hands them to the workers through lock-free
+// bounded queues, so a slow handler never stalls the kernel queue.
+// Steady state performs no heap allocation.
+//
+// - unordered: one shared MPMC queue, any worker takes any message
+// - ordered:   one queue per worker; messages with the same key (sender)
+//              always land on the same worker, keeping their order
+// If no buffer or queue slot is free the message is dropped and counted.
+// ------------------------------
+
+#include "MailslotPool.h"
+#include "MailslotTransport.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ------------------------------
+// Bounded MPMC queue (Vyukov): one CAS per push/pop, no locks
+// Capacity is rounded up to a power of two.
+// ------------------------------
+template <typename T>
+class MailslotBoundedQueue {
+public:
+    explicit MailslotBoundedQueue(uint32_t capacity) {
+        uint32_t rounded = 2;
+        while (rounded < capacity) rounded <<= 1;
+        mask_ = rounded - 1;
+        cells_.reset(new Cell[rounded]);
+        for (uint32_t i = 0; i < rounded; i++) cells_[i].sequence.store(i, std::memory_order_relaxed);
+        enqueuePos_.store(0, std::memory_order_relaxed);
+        dequeuePos_.store(0, std::memory_order_relaxed);
+    }
+
+    bool TryPush(const T& value) {
+        Cell* cell;
+        uint64_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos & mask_];
+            uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+            int64_t diff = (int64_t)sequence - (int64_t)pos;
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;                 // full
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T* value) {
+        Cell* cell;
+        uint64_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos & mask_];
+            uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+            int64_t diff = (int64_t)sequence - (int64_t)(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;                 // empty
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        *value = cell->value;
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate number of queued items
+    uint64_t Size() const {
+        uint64_t head = dequeuePos_.load(std::memory_order_relaxed);
+        uint64_t tail = enqueuePos_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    uint32_t Capacity() const { return mask_ + 1; }
+
+    // Fault in every cell before the first item (startup, before other
+    // threads use the queue)
+    void Prefault() { MailslotPrefault(cells_.get(), sizeof(Cell) * Capacity()); }
+
+private:
+    struct Cell {
+        std::atomic<uint64_t> sequence;
+        T value;
+    };
+    std::unique_ptr<Cell[]> cells_;
+    uint32_t mask_ = 0;
+    alignas(64) std::atomic<uint64_t> enqueuePos_;
+    alignas(64) std::atomic<uint64_t> dequeuePos_;
+};
+
+// ------------------------------
+// Pipeline
+// ------------------------------
+
+// Handler run on a worker thread; copy the view to keep the message longer
+typedef std::function<void(const MailslotMessageView& message, uint32_t worker)> MailslotPipelineHandler;
+// Ordering key of a message (e.g. sender id); equal keys keep their order
+typedef std::function<uint32_t(const char* data, uint32_t length)> MailslotPipelineKey;
+// Runs on the reader for every received batch before it is queued (e.g. journal)
+typedef std::function<void(const MailslotMessage* messages, uint32_t count)> MailslotPipelineTap;
+// Called on the reader thread with the number of messages dropped (no free buffer / queue slot)
+typedef std::function<void(uint32_t count)> MailslotPipelineDrop;
+
+struct MailslotPipelineConfig {
+    uint32_t workers = 4;                 // worker threads
+    uint32_t queueDepth = 4096;           // buffers in flight (pool size)
+    bool ordered = false;                 // keep per-key order
+    MailslotPipelineKey keyOf;            // ordered mode; empty — every message has key 0
+    uint32_t lateMs = 1000;               // queued longer than this counts as late
+    MailslotPipelineTap tap;              // optional
+    MailslotPipelineDrop onDrop;          // optional, e.g. return flow-control credits
+    bool prefault = false;                // fault in the buffer pool at start (MailslotStartup.h)
+};
+
+struct MailslotPipelineStats {
+    std::atomic<uint64_t> received{0};    // messages taken from the slot
+    std::atomic<uint64_t> processed{0};   // handler calls completed
+    std::atomic<uint64_t> dropped{0};     // no free buffer / queue slot
+    std::atomic<uint64_t> late{0};        // waited longer than lateMs in the queue
+    std::atomic<uint64_t> maxDepth{0};    // high-water mark of queued messages
+};
+
+struct MailslotPipelineItem {
+    MailslotPoolBlock* block;             // one reference, owned by the queue
+    std::chrono::steady_clock::time_point enqueued;
+};
+
+struct MailslotPipeline {
+    MailslotPipelineConfig config;
+    MailslotPipelineHandler handler;
+    MailslotPipelineStats stats;
+
+    std::unique_ptr<MailslotPool> pool;   // queueDepth buffers of maxMessageSize
+    // unordered: queues[0] shared by all workers; ordered: one per worker
+    std::vector<std::unique_ptr<MailslotBoundedQueue<MailslotPipelineItem>>> queues;
+
+    std::vector<std::thread> workers;
+    std::atomic<bool> readerDone{false};
+    std::atomic<int> sleepers{0};         // workers parked on the condition
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+};
+
+inline uint64_t MailslotPipelineDepth(const MailslotPipeline& pipeline) {
+    uint64_t depth = 0;
+    for (size_t i = 0; i < pipeline.queues.size(); i++) depth += pipeline.queues[i]->Size();
+    return depth;
+}
+
+inline void MailslotPipelineWorker(MailslotPipeline* pipeline, uint32_t worker) {
+    MailslotBoundedQueue<MailslotPipelineItem>& queue =
+        *pipeline->queues[pipeline->config.ordered ? worker : 0];
+    const std::chrono::milliseconds lateAfter(pipeline->config.lateMs);
+    int idle = 0;
+    while (true) {
+        MailslotPipelineItem item;
+        if (queue.TryPop(&item)) {
+            idle = 0;
+            if (std::chrono::steady_clock::now() - item.enqueued > lateAfter) {
+                pipeline->stats.late.fetch_add(1, std::memory_order_relaxed);
+            }
+            MailslotMessageView message(item.block);  // released after the handler
+            pipeline->handler(message, worker);
+            message.Reset();
+            pipeline->stats.processed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (pipeline->readerDone.load(std::memory_order_acquire) && queue.Size() == 0) return;
+
+        // Spin a little, then park until the reader signals new work
+        if (++idle < 256) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(pipeline->sleepMutex);
+        pipeline->sleepers.fetch_add(1, std::memory_order_seq_cst);
+        if (queue.Size() == 0 && !pipeline->readerDone.load(std::memory_order_acquire)) {
+            pipeline->wake.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        pipeline->sleepers.fetch_sub(1, std::memory_order_relaxed);
+        idle = 0;
+    }
+}
+
+// Allocate buffers and start the workers
+inline void MailslotPipelineStart(MailslotPipeline& pipeline, const MailslotPipelineConfig& config,
+                                  uint32_t maxMessageSize, MailslotPipelineHandler handler) {
+    pipeline.config = config;
+    if (pipeline.config.workers == 0) pipeline.config.workers = 1;
+    pipeline.handler = handler;
+    pipeline.pool.reset(new MailslotPool(config.queueDepth, maxMessageSize));
+    if (config.prefault) pipeline.pool->Prefault();
+
+    uint32_t queueCount = pipeline.config.ordered ? pipeline.config.workers : 1;
+    for (uint32_t i = 0; i < queueCount; i++) {
+        pipeline.queues.emplace_back(new MailslotBoundedQueue<MailslotPipelineItem>(config.queueDepth));
+    }
+    for (uint32_t i = 0; i < pipeline.config.workers; i++) {
+        pipeline.workers.emplace_back(MailslotPipelineWorker, &pipeline, i);
+    }
+}
+
+// Reader loop: runs on the calling thread until a receive fails
+// (timeout or error — the last error is left for the caller), then lets
+// the workers finish the queued messages and joins them.
+inline void MailslotPipelineRun(MailslotPipeline& pipeline, MailslotServer& server) {
+    MailslotMessage batch[MAILSLOT_BATCH_MAX];
+    MailslotPoolBlock* blocks[MAILSLOT_BATCH_MAX];
+    MailslotPool& pool = *pipeline.pool;
+    std::vector<char> scratch(pool.Capacity());   // target when the pool is exhausted
+    uint32_t owned = 0;                   // pooled buffers currently in batch
+
+    while (true) {
+        // Block 1: point the batch at free pooled buffers
+        while (owned < MAILSLOT_BATCH_MAX && (blocks[owned] = pool.AcquireBlock()) != nullptr) owned++;
+        uint32_t slots = owned > 0 ? owned : 1;
+        for (uint32_t i = 0; i < slots; i++) {
+            batch[i].buffer = owned > 0 ? blocks[i]->Data() : scratch.data();
+            batch[i].capacity = pool.Capacity();
+        }
+
+        // Block 2: drain the slot
+        uint32_t received = 0;
+        if (!MailslotReceiveMany(server, batch, slots, &received)) break;
+        pipeline.stats.received.fetch_add(received, std::memory_order_relaxed);
+        if (pipeline.config.tap) pipeline.config.tap(batch, received);
+        if (owned == 0) {                 // every buffer is busy — drop
+            pipeline.stats.dropped.fetch_add(received, std::memory_order_relaxed);
+            if (pipeline.config.onDrop) pipeline.config.onDrop(received);
+            continue;
+        }
+
+        // Block 3: hand the filled buffers to the workers
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        uint32_t dropped = 0;
+        for (uint32_t i = 0; i < received; i++) {
+            blocks[i]->length = batch[i].length;
+            MailslotPipelineItem item = { blocks[i], now };
+            uint32_t queue = 0;
+            if (pipeline.config.ordered) {
+                uint32_t key = pipeline.config.keyOf ? pipeline.config.keyOf(batch[i].buffer, batch[i].length) : 0;
+                queue = key % pipeline.config.workers;
+            }
+            if (!pipeline.queues[queue]->TryPush(item)) {
+                pipeline.stats.dropped.fetch_add(1, std::memory_order_relaxed);
+                pool.ReleaseBlock(blocks[i]);
+                dropped++;
+            }
+        }
+        if (dropped > 0 && pipeline.config.onDrop) pipeline.config.onDrop(dropped);
+        // Unused buffers stay owned for the next batch
+        for (uint32_t i = received; i < owned; i++) blocks[i - received] = blocks[i];
+        owned -= received;
+
+        uint64_t depth = MailslotPipelineDepth(pipeline);
+        if (depth > pipeline.stats.maxDepth.load(std::memory_order_relaxed)) {
+            pipeline.stats.maxDepth.store(depth, std::memory_order_relaxed);
+        }
+        if (pipeline.sleepers.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(pipeline.sleepMutex);
+            pipeline.wake.notify_all();
+        }
+    }
+
+    // Keep the receive error visible to the caller across the joins
+    MailslotErrorCode error = MailslotLastError();
+    for (uint32_t i = 0; i < owned; i++) pool.ReleaseBlock(blocks[i]);
+    pipeline.readerDone.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(pipeline.sleepMutex);
+        pipeline.wake.notify_all();
+    }
+    for (size_t i = 0; i < pipeline.workers.size(); i++) pipeline.workers[i].join();
+    pipeline.workers.clear();
+    MailslotSetLastError(error);
+}
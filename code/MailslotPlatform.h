@@ -0,0 +1,213 @@
+#pragma once
+
+// ------------------------------
+// MailslotPlatform: platform types, error codes and slot-name helpers
+// shared by the transport backends.
+// ------------------------------
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// ------------------------------
+// Platform types and error codes
+// Error codes keep the native values (GetLastError / errno), so they can be
+// printed and compared the same way the original WinAPI code did.
+// ------------------------------
+#ifdef _WIN32
+typedef HANDLE MailslotNativeHandle;
+typedef DWORD  MailslotErrorCode;
+#define MAILSLOT_INVALID_HANDLE             INVALID_HANDLE_VALUE
+#define MAILSLOT_ERROR_INVALID_PARAMETER    ERROR_INVALID_PARAMETER
+#define MAILSLOT_ERROR_NOT_FOUND            ERROR_FILE_NOT_FOUND
+#define MAILSLOT_ERROR_PATH_NOT_FOUND       ERROR_PATH_NOT_FOUND
+#define MAILSLOT_ERROR_ALREADY_EXISTS       ERROR_ALREADY_EXISTS
+#define MAILSLOT_ERROR_BUSY                 ERROR_PIPE_BUSY
+#define MAILSLOT_ERROR_BROKEN_PIPE          ERROR_BROKEN_PIPE
+#define MAILSLOT_ERROR_TIMEOUT              ERROR_TIMEOUT
+#define MAILSLOT_ERROR_INSUFFICIENT_BUFFER  ERROR_INSUFFICIENT_BUFFER
+#else
+typedef int MailslotNativeHandle;
+typedef int MailslotErrorCode;
+#define MAILSLOT_INVALID_HANDLE             (-1)
+#define MAILSLOT_ERROR_INVALID_PARAMETER    EINVAL
+#define MAILSLOT_ERROR_NOT_FOUND            ENOENT
+#define MAILSLOT_ERROR_PATH_NOT_FOUND       EHOSTUNREACH   // remote host on Linux
+#define MAILSLOT_ERROR_ALREADY_EXISTS       EADDRINUSE
+#define MAILSLOT_ERROR_BUSY                 EAGAIN
+#define MAILSLOT_ERROR_BROKEN_PIPE          EPIPE
+#define MAILSLOT_ERROR_TIMEOUT              ETIMEDOUT
+#define MAILSLOT_ERROR_INSUFFICIENT_BUFFER  EMSGSIZE
+#define MAILSLOT_WAIT_FOREVER               ((uint32_t)-1)
+#endif
+
+// Last error of the calling thread (GetLastError / errno)
+inline MailslotErrorCode MailslotLastError() {
+#ifdef _WIN32
+    return GetLastError();
+#else
+    return errno;
+#endif
+}
+
+inline void MailslotSetLastError(MailslotErrorCode error) {
+#ifdef _WIN32
+    SetLastError(error);
+#else
+    errno = error;
+#endif
+}
+
+// Short text for an error code (NULL for codes without one)
+inline const char* MailslotErrorText(MailslotErrorCode error) {
+    switch (error) {
+        case MAILSLOT_ERROR_INVALID_PARAMETER:   return "Invalid parameter";
+        case MAILSLOT_ERROR_NOT_FOUND:           return "Mailslot not found";
+        case MAILSLOT_ERROR_PATH_NOT_FOUND:      return "Path not found";
+        case MAILSLOT_ERROR_ALREADY_EXISTS:      return "Mailslot already exists";
+        case MAILSLOT_ERROR_BUSY:                return "Mailslot is busy";
+        case MAILSLOT_ERROR_BROKEN_PIPE:         return "Broken pipe";
+        case MAILSLOT_ERROR_TIMEOUT:             return "Timeout";
+        case MAILSLOT_ERROR_INSUFFICIENT_BUFFER: return "Insufficient buffer";
+        default:                                 return NULL;
+    }
+}
+
+// Unified error printing for Mailslot/file operations
+// operation — a short name of the API call for readable logs
+inline void HandleMailslotError(const char* operation) {
+    MailslotErrorCode error = MailslotLastError();
+    std::cerr << "Error in operation '" << operation << "': ";
+    const char* text = MailslotErrorText(error);
+    if (text != NULL) std::cerr << text;
+    else std::cerr << "Error code: " << error;
+    std::cerr << std::endl;
+}
+
+// Monotonic clock in nanoseconds, comparable across processes on one host
+// (QueryPerformanceCounter on Windows, CLOCK_MONOTONIC on Linux)
+inline uint64_t MailslotNowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// CPU time used by this process (all threads, user + kernel) in nanoseconds
+inline uint64_t MailslotProcessCpuNs() {
+#ifdef _WIN32
+    FILETIME creation, exitTime, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user)) return 0;
+    uint64_t ticks = ((uint64_t)kernel.dwHighDateTime << 32 | kernel.dwLowDateTime) +
+                     ((uint64_t)user.dwHighDateTime << 32 | user.dwLowDateTime);
+    return ticks * 100;                         // 100 ns units
+#else
+    timespec now;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now) != 0) return 0;
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#endif
+}
+
+// Virtual memory page size in bytes
+inline size_t MailslotPageSize() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+// Fault in every page of a buffer by rewriting one byte per page (contents
+// are kept), so the first messages do not pay for page faults; call it
+// before other threads use the buffer
+inline void MailslotPrefault(void* data, size_t length) {
+    if (data == nullptr || length == 0) return;
+    static const size_t page = MailslotPageSize();
+    volatile char* bytes = (volatile char*)data;
+    for (size_t offset = 0; offset < length; offset += page) bytes[offset] = bytes[offset];
+    bytes[length - 1] = bytes[length - 1];
+}
+
+// Console setup: Windows-1251 for input and output (no-op elsewhere)
+inline void MailslotInitConsole() {
+#ifdef _WIN32
+    SetConsoleCP(1251);                         // Console input in 1251
+    SetConsoleOutputCP(1251);                   // Console output in 1251
+#endif
+}
+
+// ------------------------------
+// Slot names
+// ------------------------------
+
+// \\.\mailslot\<slot>
+inline std::string MailslotLocalName(const std::string& slot) {
+    return "\\\\.\\mailslot\\" + slot;
+}
+
+// \\<host>\mailslot\<slot>; "." and "localhost" map to the local form
+inline std::string MailslotRemoteName(const std::string& host, const std::string& slot) {
+    if (host == "." || host == "localhost") return MailslotLocalName(slot);
+    return "\\\\" + host + "\\mailslot\\" + slot;
+}
+
+// Split a mailslot name into its slot path for a same-host backend:
+// \\.\mailslot\a\b -> "a/b"
+// Fails with MAILSLOT_ERROR_INVALID_PARAMETER for malformed names and with
+// MAILSLOT_ERROR_PATH_NOT_FOUND when the host is not the local machine.
+inline bool MailslotLocalSlotPath(const std::string& name, std::string* path) {
+    static const char kPrefix[] = "\\mailslot\\";
+    if (name.size() < 3 || name[0] != '\\' || name[1] != '\\') {
+        MailslotSetLastError(MAILSLOT_ERROR_INVALID_PARAMETER);
+        return false;
+    }
+    size_t hostEnd = name.find('\\', 2);
+    if (hostEnd == std::string::npos || name.compare(hostEnd, sizeof(kPrefix) - 1, kPrefix) != 0 ||
+        hostEnd + sizeof(kPrefix) - 1 == name.size()) {
+        MailslotSetLastError(MAILSLOT_ERROR_INVALID_PARAMETER);
+        return false;
+    }
+    std::string host = name.substr(2, hostEnd - 2);
+    if (host != "." && host != "localhost") {
+        char localHost[256] = {0};
+#ifdef _WIN32
+        DWORD localHostLen = sizeof(localHost);
+        GetComputerNameA(localHost, &localHostLen);
+        if (_stricmp(host.c_str(), localHost) != 0) {
+#else
+        gethostname(localHost, sizeof(localHost) - 1);
+        if (host != localHost) {
+#endif
+            MailslotSetLastError(MAILSLOT_ERROR_PATH_NOT_FOUND);
+            return false;
+        }
+    }
+
+    *path = name.substr(hostEnd + sizeof(kPrefix) - 1);
+    for (size_t i = 0; i < path->size(); i++) {
+        if ((*path)[i] == '\\') (*path)[i] = '/';
+    }
+    return true;
+}
+
+#ifdef _WIN32
+// Utility: ANSI (Windows-1251) -> UTF‑16
+// Required to build a proper wide-string for the *W WinAPI calls
+inline std::wstring MailslotWideName(const std::string& s) {
+    if (s.empty()) return std::wstring();
+    int len = MultiByteToWideChar(1251, 0, s.c_str(), (int)s.size(), NULL, 0); // compute length
+    std::wstring ws; ws.resize(len);
+    MultiByteToWideChar(1251, 0, s.c_str(), (int)s.size(), &ws[0], len);       // convert
+    return ws;
+}
+#endif
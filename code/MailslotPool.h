@@ -0,0 +1,155 @@
+#pragma once
+
+// ------------------------------
+// MailslotPool: fixed-size slab of message buffers
+// One allocation up front (blockCount blocks of header + maxMessageSize),
+// then a lock-free free list: acquiring and releasing a block never touches
+// the heap. Blocks are handed out as reference-counted MailslotMessageView
+// handles, so a message can outlive the receive loop iteration (queues,
+// workers, journals) without copying or allocating.
+// ------------------------------
+
+#include "MailslotPlatform.h"
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+
+static const uint32_t kPoolNil = 0xFFFFFFFFu;
+
+// Block header, followed by the payload bytes
+struct MailslotPoolBlock {
+    std::atomic<uint32_t> refs;           // views holding the block
+    uint32_t length;                      // payload bytes in use
+    uint32_t index;                       // position in the slab
+    std::atomic<uint32_t> next;           // free-list link
+    class MailslotPool* pool;
+
+    char* Data() { return reinterpret_cast<char*>(this + 1); }
+};
+
+class MailslotPool {
+public:
+    // blockCount     — buffers in the slab
+    // maxMessageSize — payload bytes per buffer (the slot's nMaxMessage)
+    MailslotPool(uint32_t blockCount, uint32_t maxMessageSize)
+        : blockCount_(blockCount), capacity_(maxMessageSize) {
+        blockSize_ = (uint32_t)((sizeof(MailslotPoolBlock) + maxMessageSize + 63) & ~(size_t)63);
+        storage_.reset(new char[(size_t)blockSize_ * blockCount + 64]);
+        base_ = reinterpret_cast<char*>(((uintptr_t)storage_.get() + 63) & ~(uintptr_t)63);
+        for (uint32_t i = 0; i < blockCount; i++) {
+            MailslotPoolBlock* block = new (base_ + (size_t)i * blockSize_) MailslotPoolBlock();
+            block->refs.store(0, std::memory_order_relaxed);
+            block->length = 0;
+            block->index = i;
+            block->next.store((i + 1 < blockCount) ? i + 1 : kPoolNil, std::memory_order_relaxed);
+            block->pool = this;
+        }
+        head_.store(blockCount > 0 ? 0 : kPoolNil, std::memory_order_relaxed);
+    }
+
+    MailslotPool(const MailslotPool&) = delete;
+    MailslotPool& operator=(const MailslotPool&) = delete;
+
+    // Take a free block (refs == 1); nullptr when the pool is exhausted
+    MailslotPoolBlock* AcquireBlock() {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        while (true) {
+            uint32_t index = (uint32_t)head;
+            if (index == kPoolNil) return nullptr;
+            uint64_t next = ((head >> 32) + 1) << 32 |
+                            Block(index)->next.load(std::memory_order_relaxed); // tag defeats ABA
+            if (head_.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                MailslotPoolBlock* block = Block(index);
+                block->refs.store(1, std::memory_order_relaxed);
+                block->length = 0;
+                uint32_t used = inUse_.fetch_add(1, std::memory_order_relaxed) + 1;
+                uint32_t high = highWater_.load(std::memory_order_relaxed);
+                while (used > high && !highWater_.compare_exchange_weak(high, used, std::memory_order_relaxed)) {
+                }
+                return block;
+            }
+        }
+    }
+
+    // Return a block whose last reference was dropped
+    void ReleaseBlock(MailslotPoolBlock* block) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        while (true) {
+            block->next.store((uint32_t)head, std::memory_order_relaxed);
+            uint64_t next = ((head >> 32) + 1) << 32 | block->index;
+            if (head_.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed)) break;
+        }
+        inUse_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    MailslotPoolBlock* Block(uint32_t index) const {
+        return reinterpret_cast<MailslotPoolBlock*>(base_ + (size_t)index * blockSize_);
+    }
+
+    // Fault in the whole slab before the first message (startup, before
+    // other threads use the pool)
+    void Prefault() { MailslotPrefault(base_, (size_t)blockSize_ * blockCount_); }
+
+    uint32_t Capacity() const { return capacity_; }        // payload bytes per block
+    uint32_t BlockCount() const { return blockCount_; }
+    uint32_t InUse() const { return inUse_.load(std::memory_order_relaxed); }
+    uint32_t HighWater() const { return highWater_.load(std::memory_order_relaxed); }
+
+private:
+    uint32_t blockCount_;
+    uint32_t capacity_;
+    uint32_t blockSize_ = 0;
+    std::unique_ptr<char[]> storage_;
+    char* base_ = nullptr;
+    alignas(64) std::atomic<uint64_t> head_{0};     // (tag << 32) | free block index
+    alignas(64) std::atomic<uint32_t> inUse_{0};
+    std::atomic<uint32_t> highWater_{0};
+};
+
+// ------------------------------
+// Reference-counted view of a pooled message
+// Copies add a reference; the last one returns the block to its pool.
+// ------------------------------
+class MailslotMessageView {
+public:
+    MailslotMessageView() {}
+    explicit MailslotMessageView(MailslotPoolBlock* adopted) : block_(adopted) {}  // takes over one reference
+    MailslotMessageView(const MailslotMessageView& other) : block_(other.block_) {
+        if (block_ != nullptr) block_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    MailslotMessageView(MailslotMessageView&& other) noexcept : block_(other.block_) { other.block_ = nullptr; }
+    MailslotMessageView& operator=(MailslotMessageView other) noexcept {
+        std::swap(block_, other.block_);
+        return *this;
+    }
+    ~MailslotMessageView() { Reset(); }
+
+    void Reset() {
+        if (block_ != nullptr && block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            block_->pool->ReleaseBlock(block_);
+        }
+        block_ = nullptr;
+    }
+
+    // Give up ownership without releasing (e.g. to pass through a queue)
+    MailslotPoolBlock* Detach() {
+        MailslotPoolBlock* block = block_;
+        block_ = nullptr;
+        return block;
+    }
+
+    explicit operator bool() const { return block_ != nullptr; }
+    char* Data() const { return block_->Data(); }
+    uint32_t Length() const { return block_->length; }
+    uint32_t Capacity() const { return block_->pool->Capacity(); }
+    void SetLength(uint32_t length) { block_->length = length; }
+
+private:
+    MailslotPoolBlock* block_ = nullptr;
+};
+
+// Acquire a view on a free block (empty view when the pool is exhausted)
+inline MailslotMessageView MailslotPoolAcquire(MailslotPool& pool) {
+    return MailslotMessageView(pool.AcquireBlock());
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+// ------------------------------
+// MailslotPriority: priority lanes for one logical slot
+// A slot is FIFO, so an urgent message waits behind every bulk message
+// queued before it. Priority classes get their own underlying slot (lane):
+//
+//   class     lane name
+//   control   \\.\mailslot\Box.control
+//   normal    \\.\mailslot\Box            (existing senders keep working)
+//   bulk      \\.\mailslot\Box.bulk
+//
+// and the server reads the lanes through a scheduler:
+// - strict   — always the highest-priority lane that has messages
+// - weighted — smooth weighted round robin over the lanes that have
+//              messages (default weights 8 / 4 / 1), so bulk is never starved
+// Each pick reads at most the lane's batch limit; the limits on normal and
+// bulk bound how long a control message can wait once it has arrived
+// (one lower-lane batch).
+//
+// Readiness of all lanes is one poll() on Linux; Windows mailslot handles
+// are not waitable, so lanes are checked with GetMailslotInfo and the wait
+// sleeps in 1 ms steps while all of them are empty.
+// Kernel-mode slots only (the shared-memory ring has no waitable handle).
+//
+// Senders pick the lane with MailslotPriorityLaneName; messages may also
+// carry a deadline (MAILSLOT_FRAME_FLAG_DEADLINE, see MailslotFrame.h) so
+// that bulk work which waited too long is dropped unhandled.
+// ------------------------------
+
+#include "MailslotTransport.h"
+#include <algorithm>
+#include <string>
+
+enum MailslotPriority {
+    MAILSLOT_PRIORITY_CONTROL,
+    MAILSLOT_PRIORITY_NORMAL,
+    MAILSLOT_PRIORITY_BULK
+};
+static const uint32_t kPriorityLanes = 3;
+
+enum MailslotLaneScheduling {
+    MAILSLOT_LANES_STRICT,
+    MAILSLOT_LANES_WEIGHTED
+};
+
+inline const char* MailslotPriorityName(uint32_t priority) {
+    static const char* names[kPriorityLanes] = { "control", "normal", "bulk" };
+    return priority < kPriorityLanes ? names[priority] : "?";
+}
+
+// "control" | "normal" | "bulk"
+inline bool MailslotPriorityParse(const std::string& text, MailslotPriority* priority) {
+    for (uint32_t i = 0; i < kPriorityLanes; i++) {
+        if (text == MailslotPriorityName(i)) {
+            *priority = (MailslotPriority)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Slot name of a priority lane: the normal lane is the slot itself
+inline std::string MailslotPriorityLaneName(const std::string& name, MailslotPriority priority) {
+    if (priority == MAILSLOT_PRIORITY_NORMAL) return name;
+    return name + "." + MailslotPriorityName(priority);
+}
+
+struct MailslotLaneConfig {
+    MailslotLaneScheduling scheduling = MAILSLOT_LANES_STRICT;
+    uint32_t weights[kPriorityLanes] = { 8, 4, 1 };              // weighted: share of picks
+    uint32_t batch[kPriorityLanes] = { MAILSLOT_BATCH_MAX, 16, 16 }; // datagrams per pick
+};
+
+struct MailslotLane {
+    MailslotServer server;
+    int64_t current = 0;                  // weighted round robin state
+    uint64_t datagrams = 0;               // datagrams read
+    uint64_t picks = 0;                   // batches read
+};
+
+struct MailslotLaneSet {
+    MailslotLane lanes[kPriorityLanes];
+    MailslotLaneConfig config;
+    uint32_t readTimeoutMs = 0;           // default MailslotLanesReceive wait
+};
+
+inline void MailslotLanesClose(MailslotLaneSet& set) {
+    for (uint32_t i = 0; i < kPriorityLanes; i++) MailslotClose(set.lanes[i].server);
+}
+
+// Create every lane of name (see MailslotPriorityLaneName)
+// Returns false with the last error set; lanes created so far are closed.
+inline bool MailslotLanesCreate(MailslotLaneSet& set, const std::string& name, uint32_t maxMessageSize,
+                                uint32_t readTimeoutMs, const MailslotLaneConfig& config = MailslotLaneConfig()) {
+    set.config = config;
+    set.readTimeoutMs = readTimeoutMs;
+    for (uint32_t i = 0; i < kPriorityLanes; i++) {
+        set.config.batch[i] = std::max<uint32_t>(1, std::min<uint32_t>(set.config.batch[i], MAILSLOT_BATCH_MAX));
+        set.config.weights[i] = std::max<uint32_t>(1, set.config.weights[i]);
+        set.lanes[i] = MailslotLane();
+        // Lanes never wait themselves: MailslotLanesReceive waits on all of them
+        if (!MailslotCreate(set.lanes[i].server, MailslotPriorityLaneName(name, (MailslotPriority)i),
+                            maxMessageSize, 0)) {
+            MailslotErrorCode error = MailslotLastError();
+            MailslotLanesClose(set);
+            MailslotSetLastError(error);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Lanes with pending messages: bit i set for lane i.
+// Waits up to timeoutMs for the first one; 0 on timeout or error.
+inline uint32_t MailslotLanesWait(MailslotLaneSet& set, uint32_t timeoutMs) {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+#ifdef _WIN32
+    while (true) {
+        uint32_t ready = 0;
+        for (uint32_t i = 0; i < kPriorityLanes; i++) {
+            DWORD nextSize = 0;
+            if (GetMailslotInfo(set.lanes[i].server.handle, NULL, &nextSize, NULL, NULL) &&
+                nextSize != MAILSLOT_NO_MESSAGE) {
+                ready |= 1u << i;
+            }
+        }
+        if (ready != 0) return ready;
+        if (timeoutMs != MAILSLOT_WAIT_FOREVER && Clock::now() >= deadline) {
+            MailslotSetLastError(MAILSLOT_ERROR_TIMEOUT);
+            return 0;
+        }
+        Sleep(1);
+    }
+#else
+    pollfd readable[kPriorityLanes];
+    for (uint32_t i = 0; i < kPriorityLanes; i++) {
+        readable[i].fd = set.lanes[i].server.handle;
+        readable[i].events = POLLIN;
+        readable[i].revents = 0;
+    }
+    while (true) {
+        int waitMs = -1;
+        if (timeoutMs != MAILSLOT_WAIT_FOREVER) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            waitMs = left > 0 ? (int)left : 0;
+        }
+        int count = poll(readable, kPriorityLanes, waitMs);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        if (count == 0) {
+            errno = MAILSLOT_ERROR_TIMEOUT;
+            return 0;
+        }
+        uint32_t ready = 0;
+        for (uint32_t i = 0; i < kPriorityLanes; i++) {
+            if (readable[i].revents & POLLIN) ready |= 1u << i;
+        }
+        if (ready != 0) return ready;
+    }
+#endif
+}
+
+// Scheduler: the lane to read next among the ready ones
+inline uint32_t MailslotLanesPick(MailslotLaneSet& set, uint32_t ready) {
+    if (set.config.scheduling == MAILSLOT_LANES_STRICT) {
+        for (uint32_t i = 0; i < kPriorityLanes; i++) {
+            if (ready & (1u << i)) return i;
+        }
+    }
+    // Smooth weighted round robin: every ready lane gains its weight, the
+    // richest is picked and pays the total — picks interleave in proportion
+    int64_t total = 0;
+    uint32_t best = kPriorityLanes;
+    for (uint32_t i = 0; i < kPriorityLanes; i++) {
+        if ((ready & (1u << i)) == 0) continue;
+        MailslotLane& lane = set.lanes[i];
+        lane.current += set.config.weights[i];
+        total += set.config.weights[i];
+        if (best == kPriorityLanes || lane.current > set.lanes[best].current) best = i;
+    }
+    set.lanes[best].current -= total;
+    return best;
+}
+
+// Receive one batch from the lane the scheduler picks; *lane tells which.
+// Waits up to timeoutMs for any lane. Returns false (with *received == 0)
+// on timeout (MAILSLOT_ERROR_TIMEOUT) or error.
+inline bool MailslotLanesReceive(MailslotLaneSet& set, MailslotMessage* messages, uint32_t count,
+                                 uint32_t* received, uint32_t* lane, uint32_t timeoutMs) {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    *received = 0;
+    while (true) {
+        // Block 1: which lanes have messages
+        uint32_t waitMs = timeoutMs;
+        if (timeoutMs != MAILSLOT_WAIT_FOREVER) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            waitMs = left > 0 ? (uint32_t)left : 0;
+        }
+        uint64_t waitBeginNs = MailslotStatsReadBegin();
+        uint32_t ready = MailslotLanesWait(set, waitMs);
+        MailslotStatsWaitEnd(waitBeginNs);
+        if (ready == 0) {
+            MailslotErrorCode error = MailslotLastError();
+            MailslotStatsReadFailed(error);
+            MailslotSetLastError(error);
+            return false;
+        }
+
+        // Block 2: one bounded batch from the scheduled lane
+        uint32_t pick = MailslotLanesPick(set, ready);
+        MailslotLane& chosen = set.lanes[pick];
+        uint32_t limit = std::min(count, set.config.batch[pick]);
+        if (MailslotReceiveMany(chosen.server, messages, limit, received, 0)) {
+            chosen.datagrams += *received;
+            chosen.picks++;
+            *lane = pick;
+            return true;
+        }
+        // Only oversized datagrams were pending: wait again
+        if (MailslotLastError() != MAILSLOT_ERROR_TIMEOUT) return false;
+    }
+}
+
+// Batched receive using the set's default read timeout
+inline bool MailslotLanesReceive(MailslotLaneSet& set, MailslotMessage* messages, uint32_t count,
+                                 uint32_t* received, uint32_t* lane) {
+    return MailslotLanesReceive(set, messages, count, received, lane, set.readTimeoutMs);
+}
+
+// Datagrams dropped by all lanes (oversized)
+inline uint64_t MailslotLanesOversizeDropped(const MailslotLaneSet& set) {
+    uint64_t dropped = 0;
+    for (uint32_t i = 0; i < kPriorityLanes; i++) dropped += set.lanes[i].server.oversizeDropped;
+    return dropped;
+}
@@ -0,0 +1,428 @@
+#pragma once
+
+// ------------------------------
+// MailslotRing: shared-memory mailslot for same-host senders
+// A variable-length-record MPSC ring in a named shared segment.
+// Senders append without any syscall; the reader is woken (futex on Linux,
+// named auto-reset event on Windows) only when it is parked.
+//
+// Record layout (8-byte aligned):
+//   [u32 state][u32 reserved][payload ...]
+//   state = committed bit | padding bit | payload length
+// Consumed records are zeroed, so a zero state word always means
+// "not yet committed" for the next header landing on those bytes.
+// Note: a sender that dies between reserving and committing a record
+// stalls the reader at that record.
+// ------------------------------
+
+#include "MailslotPlatform.h"
+#include <atomic>
+#include <chrono>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+#define MAILSLOT_RING_MAGIC            0x474E5253u   // "SRNG"
+#define MAILSLOT_RING_VERSION          1u
+#define MAILSLOT_RING_DEFAULT_CAPACITY (1u << 20)    // 1 MiB of records
+
+static const uint32_t kRingCommitted    = 0x80000000u;
+static const uint32_t kRingPadding      = 0x40000000u;
+static const uint32_t kRingLengthMask   = 0x3FFFFFFFu;
+static const uint32_t kRingRecordHeader = 8;
+static const uint32_t kRingDataOffset   = 256;        // header page part before records
+static const int      kRingSpinCount    = 128;        // polls before the reader parks
+
+// Control block at the start of the segment
+struct MailslotRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;                          // record bytes (power of two)
+    uint32_t maxMessageSize;                    // nMaxMessage
+    uint64_t ownerPid;                          // server process
+    std::atomic<uint32_t> ownerAlive;           // 1 while the server owns the slot
+    alignas(64) std::atomic<uint64_t> writePos; // reserved by senders
+    alignas(64) std::atomic<uint64_t> readPos;  // consumed by the reader
+    std::atomic<uint32_t> readerParked;         // reader is about to sleep
+    std::atomic<uint32_t> wakeSeq;              // futex word
+};
+static_assert(sizeof(MailslotRingHeader) <= kRingDataOffset, "ring header does not fit");
+
+struct MailslotRing {
+    MailslotRingHeader* header = nullptr;
+    char* data = nullptr;                       // first record byte
+    size_t mappingSize = 0;
+    std::string segmentName;
+    bool owner = false;                         // created by this process
+#ifdef _WIN32
+    HANDLE mapping = NULL;
+    HANDLE wakeEvent = NULL;
+#endif
+};
+
+inline uint32_t MailslotRingRecordSize(uint32_t length) {
+    return (kRingRecordHeader + length + 7u) & ~7u;
+}
+
+inline std::atomic<uint32_t>* MailslotRingState(const MailslotRing& ring, uint64_t pos) {
+    return reinterpret_cast<std::atomic<uint32_t>*>(ring.data + (pos & (ring.header->capacity - 1)));
+}
+
+// Segment name for a slot: \\.\mailslot\a\b -> mailslot.a.b
+inline bool MailslotRingSegmentName(const std::string& name, std::string* segment) {
+    std::string path;
+    if (!MailslotLocalSlotPath(name, &path)) return false;
+    for (size_t i = 0; i < path.size(); i++) {
+        if (path[i] == '/') path[i] = '.';
+    }
+#ifdef _WIN32
+    *segment = "Local\\mailslot." + path;
+#else
+    *segment = "/mailslot." + path;
+#endif
+    return true;
+}
+
+// ------------------------------
+// Futex / event wakeups
+// ------------------------------
+inline void MailslotRingWake(MailslotRing& ring) {
+    ring.header->wakeSeq.fetch_add(1, std::memory_order_release);
+#ifdef _WIN32
+    SetEvent(ring.wakeEvent);
+#else
+    syscall(SYS_futex, &ring.header->wakeSeq, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+}
+
+// Sleep until woken, the wake sequence moved past `seq`, or timeoutMs elapsed
+inline void MailslotRingSleep(MailslotRing& ring, uint32_t seq, uint32_t timeoutMs) {
+#ifdef _WIN32
+    (void)seq;
+    WaitForSingleObject(ring.wakeEvent, timeoutMs);
+#else
+    timespec timeout;
+    timespec* timeoutPtr = NULL;
+    if (timeoutMs != MAILSLOT_WAIT_FOREVER) {
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = (long)(timeoutMs % 1000) * 1000000L;
+        timeoutPtr = &timeout;
+    }
+    syscall(SYS_futex, &ring.header->wakeSeq, FUTEX_WAIT, seq, timeoutPtr, NULL, 0);
+#endif
+}
+
+// ------------------------------
+// Segment lifetime
+// ------------------------------
+
+inline void MailslotRingUnmap(MailslotRing& ring) {
+    if (ring.header == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(ring.header);
+    CloseHandle(ring.mapping);
+    if (ring.wakeEvent != NULL) CloseHandle(ring.wakeEvent);
+    ring.mapping = NULL;
+    ring.wakeEvent = NULL;
+#else
+    munmap(ring.header, ring.mappingSize);
+#endif
+    ring.header = nullptr;
+    ring.data = nullptr;
+}
+
+// Create the reader side of a ring slot
+// capacity is rounded up to a power of two large enough for two max-size records.
+inline bool MailslotRingCreate(MailslotRing& ring, const std::string& name,
+                               uint32_t maxMessageSize, uint32_t capacity) {
+    if (maxMessageSize == 0 || maxMessageSize > kRingLengthMask) {
+        MailslotSetLastError(MAILSLOT_ERROR_INVALID_PARAMETER);
+        return false;
+    }
+    if (!MailslotRingSegmentName(name, &ring.segmentName)) return false;
+
+    uint32_t minimum = 2 * MailslotRingRecordSize(maxMessageSize);
+    uint32_t rounded = 64;
+    while (rounded < capacity || rounded < minimum) rounded <<= 1;
+    ring.mappingSize = kRingDataOffset + (size_t)rounded;
+
+#ifdef _WIN32
+    std::wstring segment = MailslotWideName(ring.segmentName);
+    ring.mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                      0, (DWORD)ring.mappingSize, segment.c_str());
+    if (ring.mapping == NULL) return false;
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        CloseHandle(ring.mapping);
+        ring.mapping = NULL;
+        MailslotSetLastError(MAILSLOT_ERROR_ALREADY_EXISTS);
+        return false;
+    }
+    std::wstring wakeName = segment + L".wake";
+    ring.wakeEvent = CreateEventW(NULL, FALSE, FALSE, wakeName.c_str()); // auto-reset
+    void* base = MapViewOfFile(ring.mapping, FILE_MAP_ALL_ACCESS, 0, 0, ring.mappingSize);
+    if (ring.wakeEvent == NULL || base == NULL) {
+        DWORD error = GetLastError();
+        if (base != NULL) UnmapViewOfFile(base);
+        if (ring.wakeEvent != NULL) CloseHandle(ring.wakeEvent);
+        CloseHandle(ring.mapping);
+        ring.mapping = NULL;
+        ring.wakeEvent = NULL;
+        SetLastError(error);
+        return false;
+    }
+    uint64_t ownerPid = GetCurrentProcessId();
+#else
+    int fd = shm_open(ring.segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        // A segment outlives a crashed server; only a live owner blocks creation
+        int existing = shm_open(ring.segmentName.c_str(), O_RDONLY | O_CLOEXEC, 0);
+        bool alive = false;
+        if (existing >= 0) {
+            struct stat info;
+            if (fstat(existing, &info) == 0 && (size_t)info.st_size >= sizeof(MailslotRingHeader)) {
+                void* view = mmap(NULL, sizeof(MailslotRingHeader), PROT_READ, MAP_SHARED, existing, 0);
+                if (view != MAP_FAILED) {
+                    const MailslotRingHeader* old = (const MailslotRingHeader*)view;
+                    alive = old->ownerAlive.load(std::memory_order_acquire) != 0 &&
+                            kill((pid_t)old->ownerPid, 0) == 0;
+                    munmap(view, sizeof(MailslotRingHeader));
+                }
+            }
+            close(existing);
+        }
+        if (alive) {
+            errno = MAILSLOT_ERROR_ALREADY_EXISTS;
+            return false;
+        }
+        shm_unlink(ring.segmentName.c_str());
+        fd = shm_open(ring.segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+    }
+    if (fd < 0) {
+        if (errno == EEXIST) errno = MAILSLOT_ERROR_ALREADY_EXISTS;
+        return false;
+    }
+    if (ftruncate(fd, (off_t)ring.mappingSize) != 0) {
+        int error = errno;
+        close(fd);
+        shm_unlink(ring.segmentName.c_str());
+        errno = error;
+        return false;
+    }
+    void* base = mmap(NULL, ring.mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        int error = errno;
+        shm_unlink(ring.segmentName.c_str());
+        errno = error;
+        return false;
+    }
+    uint64_t ownerPid = (uint64_t)getpid();
+#endif
+
+    // Fresh segment memory is zero-filled: every record state starts uncommitted
+    ring.header = new (base) MailslotRingHeader();
+    ring.data = (char*)base + kRingDataOffset;
+    ring.header->magic = MAILSLOT_RING_MAGIC;
+    ring.header->version = MAILSLOT_RING_VERSION;
+    ring.header->capacity = rounded;
+    ring.header->maxMessageSize = maxMessageSize;
+    ring.header->ownerPid = ownerPid;
+    ring.header->writePos.store(0, std::memory_order_relaxed);
+    ring.header->readPos.store(0, std::memory_order_relaxed);
+    ring.header->readerParked.store(0, std::memory_order_relaxed);
+    ring.header->wakeSeq.store(0, std::memory_order_relaxed);
+    ring.header->ownerAlive.store(1, std::memory_order_release); // publish
+    ring.owner = true;
+    return true;
+}
+
+// Open the sender side of an existing ring slot
+inline bool MailslotRingOpen(MailslotRing& ring, const std::string& name) {
+    if (!MailslotRingSegmentName(name, &ring.segmentName)) return false;
+    void* base = NULL;
+#ifdef _WIN32
+    std::wstring segment = MailslotWideName(ring.segmentName);
+    ring.mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, segment.c_str());
+    if (ring.mapping == NULL) {
+        MailslotSetLastError(MAILSLOT_ERROR_NOT_FOUND);
+        return false;
+    }
+    std::wstring wakeName = segment + L".wake";
+    ring.wakeEvent = OpenEventW(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, wakeName.c_str());
+    base = MapViewOfFile(ring.mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (ring.wakeEvent == NULL || base == NULL) {
+        if (base != NULL) UnmapViewOfFile(base);
+        if (ring.wakeEvent != NULL) CloseHandle(ring.wakeEvent);
+        CloseHandle(ring.mapping);
+        ring.mapping = NULL;
+        ring.wakeEvent = NULL;
+        MailslotSetLastError(MAILSLOT_ERROR_NOT_FOUND);
+        return false;
+    }
+    MEMORY_BASIC_INFORMATION region;
+    VirtualQuery(base, &region, sizeof(region));
+    ring.mappingSize = region.RegionSize;
+#else
+    int fd = shm_open(ring.segmentName.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) return false;                 // ENOENT == MAILSLOT_ERROR_NOT_FOUND
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size <= kRingDataOffset) {
+        close(fd);
+        errno = MAILSLOT_ERROR_NOT_FOUND;
+        return false;
+    }
+    ring.mappingSize = (size_t)info.st_size;
+    base = mmap(NULL, ring.mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+#endif
+    ring.header = (MailslotRingHeader*)base;
+    ring.data = (char*)base + kRingDataOffset;
+    ring.owner = false;
+    if (ring.header->ownerAlive.load(std::memory_order_acquire) == 0 ||
+        ring.header->magic != MAILSLOT_RING_MAGIC || ring.header->version != MAILSLOT_RING_VERSION ||
+        kRingDataOffset + (size_t)ring.header->capacity > ring.mappingSize) {
+        MailslotRingUnmap(ring);
+        MailslotSetLastError(MAILSLOT_ERROR_NOT_FOUND);
+        return false;
+    }
+    return true;
+}
+
+// Close either side; the owner marks the slot dead so senders get a broken pipe
+inline void MailslotRingClose(MailslotRing& ring) {
+    if (ring.header == nullptr) return;
+    if (ring.owner) {
+        ring.header->ownerAlive.store(0, std::memory_order_release);
+#ifndef _WIN32
+        shm_unlink(ring.segmentName.c_str());
+#endif
+    }
+    MailslotRingUnmap(ring);
+}
+
+// ------------------------------
+// Sender: append one record (lock-free, no syscall unless the reader is parked)
+// ------------------------------
+inline bool MailslotRingPush(MailslotRing& ring, const void* message, uint32_t length) {
+    MailslotRingHeader* header = ring.header;
+    if (header->ownerAlive.load(std::memory_order_relaxed) == 0) {
+        MailslotSetLastError(MAILSLOT_ERROR_BROKEN_PIPE);
+        return false;
+    }
+    if (length > header->maxMessageSize) {    // same contract as nMaxMessage
+        MailslotSetLastError(MAILSLOT_ERROR_INSUFFICIENT_BUFFER);
+        return false;
+    }
+
+    // Block 1: reserve space; a record never wraps, the tail is padded instead
+    const uint64_t capacity = header->capacity;
+    const uint32_t need = MailslotRingRecordSize(length);
+    uint64_t pos = header->writePos.load(std::memory_order_relaxed);
+    uint64_t total = 0;
+    uint32_t tail = 0;
+    do {
+        tail = (uint32_t)(capacity - (pos & (capacity - 1)));
+        total = (need <= tail) ? need : (uint64_t)tail + need;
+        if (pos + total - header->readPos.load(std::memory_order_acquire) > capacity) {
+            MailslotSetLastError(MAILSLOT_ERROR_BUSY);   // ring full
+            return false;
+        }
+    } while (!header->writePos.compare_exchange_weak(pos, pos + total,
+                                                      std::memory_order_relaxed,
+                                                      std::memory_order_relaxed));
+
+    // Block 2: padding record up to the end of the buffer
+    if (total != need) {
+        MailslotRingState(ring, pos)->store(kRingCommitted | kRingPadding | (tail - kRingRecordHeader),
+                                            std::memory_order_release);
+        pos += tail;
+    }
+
+    // Block 3: payload, then publish the state word
+    memcpy(ring.data + (pos & (capacity - 1)) + kRingRecordHeader, message, length);
+    MailslotRingState(ring, pos)->store(kRingCommitted | length, std::memory_order_release);
+
+    // Block 4: wake the reader only if it is parked
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header->readerParked.load(std::memory_order_relaxed) != 0) {
+        MailslotRingWake(ring);
+    }
+    return true;
+}
+
+// ------------------------------
+// Reader: take one record, waiting up to timeoutMs
+// A too-small buffer leaves the record in place (MAILSLOT_ERROR_INSUFFICIENT_BUFFER).
+// ------------------------------
+
+// Non-blocking take; returns false with MAILSLOT_ERROR_TIMEOUT when empty
+inline bool MailslotRingTryPop(MailslotRing& ring, char* buffer, uint32_t bufferSize, uint32_t* bytesRead) {
+    MailslotRingHeader* header = ring.header;
+    const uint32_t capacity = header->capacity;
+    uint64_t pos = header->readPos.load(std::memory_order_relaxed);
+    while (true) {
+        uint32_t state = MailslotRingState(ring, pos)->load(std::memory_order_acquire);
+        if ((state & kRingCommitted) == 0) {
+            MailslotSetLastError(MAILSLOT_ERROR_TIMEOUT);
+            return false;
+        }
+        uint32_t length = state & kRingLengthMask;
+        uint32_t recordSize = MailslotRingRecordSize(length);
+        char* record = ring.data + (pos & (capacity - 1));
+        if ((state & kRingPadding) == 0) {
+            if (length > bufferSize) {
+                MailslotSetLastError(MAILSLOT_ERROR_INSUFFICIENT_BUFFER);
+                return false;
+            }
+            memcpy(buffer, record + kRingRecordHeader, length);
+            *bytesRead = length;
+        }
+        memset(record, 0, recordSize);            // next headers may land here
+        header->readPos.store(pos + recordSize, std::memory_order_release);
+        if ((state & kRingPadding) == 0) return true;
+        pos += recordSize;
+    }
+}
+
+inline bool MailslotRingPop(MailslotRing& ring, char* buffer, uint32_t bufferSize,
+                            uint32_t* bytesRead, uint32_t timeoutMs) {
+    *bytesRead = 0;
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    MailslotRingHeader* header = ring.header;
+    int spins = 0;
+    while (true) {
+        if (MailslotRingTryPop(ring, buffer, bufferSize, bytesRead)) return true;
+        if (MailslotLastError() != MAILSLOT_ERROR_TIMEOUT) return false;
+        if (spins++ < kRingSpinCount) continue;
+
+        // Park: announce, re-check, then sleep on the wake word
+        uint32_t waitMs = MAILSLOT_WAIT_FOREVER;
+        if (timeoutMs != MAILSLOT_WAIT_FOREVER) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            if (left <= 0) {
+                MailslotSetLastError(MAILSLOT_ERROR_TIMEOUT);
+                return false;
+            }
+            waitMs = (uint32_t)left;
+        }
+        uint32_t seq = header->wakeSeq.load(std::memory_order_acquire);
+        header->readerParked.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint32_t state = MailslotRingState(ring, header->readPos.load(std::memory_order_relaxed))
+                             ->load(std::memory_order_acquire);
+        if ((state & kRingCommitted) == 0) {
+            MailslotRingSleep(ring, seq, waitMs);
+        }
+        header->readerParked.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,431 @@
+#pragma once
+
+// ------------------------------
+// MailslotRouter: receiver-side filtering and routing
+// Rules are compiled once into a dispatch table; matching a message does
+// not scan the rules:
+// - frame type (MailslotFrameHeader::type) — perfect hash (hash and
+//   displace): a bucket's seed is chosen at compile time so that no two rule
+//   types share a slot; a lookup is two hashes, two loads and one compare,
+//   constant in the number of rules
+// - payload prefix — path-compressed trie, longest prefix wins; edge labels
+//   are checked with memcmp and the next edge is found with memchr over the
+//   node's first bytes (both vectorized by the C library). A lookup is
+//   O(prefix length): at most one node per key byte on the matched path.
+//   More rules add branch points along that path, so the cost rises with
+//   rule density until every byte is a branch, and is bounded by the key
+//   length, not by the number of rules
+// A type rule wins over a prefix rule; unmatched messages go to the default
+// route. The first rule for a type or prefix wins. Rules whose route is
+// named "drop" discard their messages before any queue or handler.
+//
+// Each route has its own bounded queue (MailslotBoundedQueue) and counters;
+// route workers serve the queues (route i on worker i % workers), so a slow
+// route fills only its own queue — when it is full, that route's messages
+// are dropped and counted.
+//
+// Rule syntax: NAME:type:N or NAME:prefix:TEXT
+// ------------------------------
+
+#include "MailslotPipeline.h"
+#include "MailslotPool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const uint32_t kRouteNone = 0xFFFFFFFFu;
+static const uint32_t kRouteTypeNone = 0xFFFFFFFFu;   // plain text: no frame type
+
+struct MailslotRouteRule {
+    std::string route;                    // route name; "drop" — discard
+    bool byType = false;
+    uint16_t type = 0;                    // byType
+    std::string prefix;                   // !byType
+};
+
+// NAME:type:N / NAME:prefix:TEXT (TEXT may contain ':')
+inline bool MailslotRouteParse(const std::string& spec, MailslotRouteRule* rule) {
+    size_t first = spec.find(':');
+    size_t second = first == std::string::npos ? std::string::npos : spec.find(':', first + 1);
+    if (first == 0 || second == std::string::npos) return false;
+    rule->route = spec.substr(0, first);
+    std::string kind = spec.substr(first + 1, second - first - 1);
+    std::string value = spec.substr(second + 1);
+    if (kind == "type") {
+        char* end = nullptr;
+        unsigned long type = strtoul(value.c_str(), &end, 0);
+        if (value.empty() || *end != '\0' || type > 0xFFFF) return false;
+        rule->byType = true;
+        rule->type = (uint16_t)type;
+        return true;
+    }
+    if (kind == "prefix" && !value.empty()) {
+        rule->byType = false;
+        rule->prefix = value;
+        return true;
+    }
+    return false;
+}
+
+// Queued for a route handler: a pooled copy of the message
+struct MailslotRoutedMessage {
+    MailslotPoolBlock* block;             // one reference, owned by the queue
+    uint32_t type;                        // frame type, kRouteTypeNone for plain text
+};
+
+struct MailslotRoute {
+    std::string name;
+    bool drop = false;
+    std::unique_ptr<MailslotBoundedQueue<MailslotRoutedMessage>> queue;
+    std::atomic<uint64_t> matched{0};     // messages matched (dropped ones too)
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> handled{0};     // handler calls completed
+    std::atomic<uint64_t> overflow{0};    // queue full or no buffer
+    std::atomic<uint64_t> maxDepth{0};
+};
+
+// Runs on a route worker; copy the view to keep the message longer
+typedef std::function<void(uint32_t route, uint32_t type, const MailslotMessageView& message)> MailslotRouteHandler;
+
+struct MailslotRouterConfig {
+    uint32_t workers = 2;                 // route worker threads
+    uint32_t queueDepth = 1024;           // messages per route queue
+    uint32_t poolBlocks = 4096;           // copies in flight across all routes
+    bool prefault = false;                // fault in the copy pool at start (MailslotStartup.h)
+};
+
+struct MailslotRouter {
+    MailslotRouterConfig config;
+    std::vector<std::unique_ptr<MailslotRoute>> routes;   // [0] — default
+    uint32_t defaultRoute = 0;
+
+    // Type table: bucket -> seed, seed + type -> slot
+    struct TypeSlot {
+        uint32_t type;                    // kRouteTypeNone — empty
+        uint32_t route;
+    };
+    std::vector<uint16_t> typeSeeds;
+    std::vector<TypeSlot> types;
+    uint32_t bucketBits = 1;
+    uint32_t slotBits = 1;
+
+    // Prefix trie, flattened: the children of a node are contiguous and
+    // childBytes[i] is the first byte of nodes[i]'s label
+    struct Node {
+        uint32_t label;                   // offset in labels
+        uint32_t labelLength;
+        uint32_t route;                   // kRouteNone — no prefix ends here
+        uint32_t firstChild;
+        uint32_t childCount;
+    };
+    std::vector<Node> nodes;              // [0] — root (empty label)
+    std::string labels;
+    std::string childBytes;
+
+    // Route workers
+    std::unique_ptr<MailslotPool> pool;   // copies of queued messages
+    MailslotRouteHandler handler;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping{false};
+    std::atomic<int> sleepers{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+};
+
+inline uint32_t MailslotRouterRouteId(MailslotRouter& router, const std::string& name) {
+    for (uint32_t i = 0; i < router.routes.size(); i++) {
+        if (router.routes[i]->name == name) return i;
+    }
+    router.routes.emplace_back(new MailslotRoute());
+    router.routes.back()->name = name;
+    router.routes.back()->drop = name == "drop";
+    return (uint32_t)router.routes.size() - 1;
+}
+
+// ------------------------------
+// Type table (perfect hash)
+// ------------------------------
+inline uint32_t MailslotRouteTypeBucket(const MailslotRouter& router, uint32_t type) {
+    return (type * 0x9E3779B1u) >> (32 - router.bucketBits);
+}
+
+inline uint32_t MailslotRouteTypeSlot(const MailslotRouter& router, uint32_t type, uint32_t seed) {
+    uint32_t x = type * 0x85EBCA77u + seed * 0xC2B2AE3Du + 0x27D4EB2Fu;
+    x ^= x >> 15;
+    x *= 0x2C1B3C6Du;
+    x ^= x >> 12;
+    return x >> (32 - router.slotBits);
+}
+
+// Find a seed per bucket (largest buckets first) that places all its types
+// in free slots; grow the table if some bucket has none
+inline void MailslotRouterCompileTypes(MailslotRouter& router, const std::vector<std::pair<uint16_t, uint32_t>>& rules) {
+    router.types.clear();
+    router.typeSeeds.clear();
+    if (rules.empty()) return;
+    router.bucketBits = 1;
+    while ((1u << router.bucketBits) < rules.size() / 2) router.bucketBits++;
+    router.slotBits = 1;
+    while ((1u << router.slotBits) < rules.size() * 2) router.slotBits++;
+
+    std::vector<std::vector<uint32_t>> buckets((size_t)1 << router.bucketBits);
+    for (uint32_t i = 0; i < rules.size(); i++) buckets[MailslotRouteTypeBucket(router, rules[i].first)].push_back(i);
+    std::vector<uint32_t> order(buckets.size());
+    for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&buckets](uint32_t a, uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+    while (true) {
+        router.typeSeeds.assign(buckets.size(), 0);
+        router.types.assign((size_t)1 << router.slotBits, MailslotRouter::TypeSlot{ kRouteTypeNone, kRouteNone });
+        bool placedAll = true;
+        for (uint32_t bucket : order) {
+            if (buckets[bucket].empty()) break;
+            bool placed = false;
+            for (uint32_t seed = 0; seed <= 0xFFFF && !placed; seed++) {
+                std::vector<uint32_t> slots;
+                placed = true;
+                for (uint32_t rule : buckets[bucket]) {
+                    uint32_t slot = MailslotRouteTypeSlot(router, rules[rule].first, seed);
+                    if (router.types[slot].type != kRouteTypeNone ||
+                        std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                        placed = false;
+                        break;
+                    }
+                    slots.push_back(slot);
+                }
+                if (!placed) continue;
+                router.typeSeeds[bucket] = (uint16_t)seed;
+                for (size_t i = 0; i < slots.size(); i++) {
+                    uint32_t rule = buckets[bucket][i];
+                    router.types[slots[i]] = MailslotRouter::TypeSlot{ rules[rule].first, rules[rule].second };
+                }
+            }
+            if (!placed) {
+                placedAll = false;
+                break;
+            }
+        }
+        if (placedAll) return;
+        router.slotBits++;                // crowded: retry with twice the slots
+    }
+}
+
+// ------------------------------
+// Prefix trie
+// ------------------------------
+struct MailslotRouteTrieBuild {
+    std::map<unsigned char, std::unique_ptr<MailslotRouteTrieBuild>> children;
+    uint32_t route = kRouteNone;
+};
+
+inline void MailslotRouterCompilePrefixes(MailslotRouter& router,
+                                          const std::vector<std::pair<std::string, uint32_t>>& rules) {
+    // Block 1: plain byte trie
+    MailslotRouteTrieBuild root;
+    for (const auto& rule : rules) {
+        MailslotRouteTrieBuild* node = &root;
+        for (unsigned char byte : rule.first) {
+            std::unique_ptr<MailslotRouteTrieBuild>& child = node->children[byte];
+            if (!child) child.reset(new MailslotRouteTrieBuild());
+            node = child.get();
+        }
+        if (node->route == kRouteNone) node->route = rule.second;   // first rule wins
+    }
+
+    // Block 2: flatten breadth-first, merging single-child chains into one label
+    router.nodes.assign(1, MailslotRouter::Node{ 0, 0, root.route, 0, 0 });
+    router.labels.clear();
+    router.childBytes.assign(1, '\0');
+    std::deque<std::pair<const MailslotRouteTrieBuild*, uint32_t>> pending;
+    pending.emplace_back(&root, 0);
+    while (!pending.empty()) {
+        const MailslotRouteTrieBuild* parent = pending.front().first;
+        uint32_t index = pending.front().second;
+        pending.pop_front();
+        router.nodes[index].firstChild = (uint32_t)router.nodes.size();
+        router.nodes[index].childCount = (uint32_t)parent->children.size();
+        for (const auto& child : parent->children) {
+            std::string label(1, (char)child.first);
+            const MailslotRouteTrieBuild* end = child.second.get();
+            while (end->route == kRouteNone && end->children.size() == 1) {
+                label += (char)end->children.begin()->first;
+                end = end->children.begin()->second.get();
+            }
+            router.nodes.push_back(MailslotRouter::Node{ (uint32_t)router.labels.size(), (uint32_t)label.size(),
+                                                         end->route, 0, 0 });
+            router.labels += label;
+            router.childBytes += label[0];
+            pending.emplace_back(end, (uint32_t)router.nodes.size() - 1);
+        }
+    }
+}
+
+// Build the dispatch table; route 0 is defaultName
+inline void MailslotRouterCompile(MailslotRouter& router, const std::vector<MailslotRouteRule>& rules,
+                                  const std::string& defaultName = "default") {
+    router.routes.clear();
+    router.defaultRoute = MailslotRouterRouteId(router, defaultName);
+    std::vector<std::pair<uint16_t, uint32_t>> types;
+    std::vector<std::pair<std::string, uint32_t>> prefixes;
+    for (const MailslotRouteRule& rule : rules) {
+        uint32_t route = MailslotRouterRouteId(router, rule.route);
+        if (!rule.byType) {
+            prefixes.emplace_back(rule.prefix, route);
+            continue;
+        }
+        bool seen = false;
+        for (const auto& type : types) seen = seen || type.first == rule.type;
+        if (!seen) types.emplace_back(rule.type, route);             // first rule wins
+    }
+    MailslotRouterCompileTypes(router, types);
+    MailslotRouterCompilePrefixes(router, prefixes);
+}
+
+// Route of one message; type — frame type or kRouteTypeNone for plain text
+inline uint32_t MailslotRouterMatch(const MailslotRouter& router, uint32_t type, const char* data, uint32_t length) {
+    // Block 1: frame type
+    if (type != kRouteTypeNone && !router.types.empty()) {
+        uint32_t seed = router.typeSeeds[MailslotRouteTypeBucket(router, type)];
+        const MailslotRouter::TypeSlot& slot = router.types[MailslotRouteTypeSlot(router, type, seed)];
+        if (slot.type == type) return slot.route;
+    }
+
+    // Block 2: longest payload prefix
+    uint32_t best = router.nodes.empty() ? kRouteNone : router.nodes[0].route;
+    uint32_t node = 0;
+    uint32_t position = 0;
+    while (!router.nodes.empty() && position < length) {
+        const MailslotRouter::Node& current = router.nodes[node];
+        if (current.childCount == 0) break;
+        const char* first = router.childBytes.data() + current.firstChild;
+        const void* hit = memchr(first, data[position], current.childCount);
+        if (hit == nullptr) break;
+        node = (uint32_t)((const char*)hit - router.childBytes.data());
+        const MailslotRouter::Node& child = router.nodes[node];
+        if (length - position < child.labelLength ||
+            memcmp(router.labels.data() + child.label, data + position, child.labelLength) != 0) {
+            break;
+        }
+        position += child.labelLength;
+        if (child.route != kRouteNone) best = child.route;
+    }
+    return best != kRouteNone ? best : router.defaultRoute;
+}
+
+// ------------------------------
+// Route queues and workers
+// ------------------------------
+inline void MailslotRouterWorker(MailslotRouter* router, uint32_t worker) {
+    uint32_t workers = (uint32_t)router->workers.size();
+    int idle = 0;
+    while (true) {
+        // Block 1: a few messages from each of this worker's routes per round
+        bool any = false;
+        bool queued = false;
+        for (uint32_t r = worker; r < router->routes.size(); r += workers) {
+            MailslotRoute& route = *router->routes[r];
+            if (!route.queue) continue;
+            MailslotRoutedMessage item;
+            for (int n = 0; n < 64 && route.queue->TryPop(&item); n++) {
+                MailslotMessageView message(item.block);   // released after the handler
+                router->handler(r, item.type, message);
+                route.handled.fetch_add(1, std::memory_order_relaxed);
+                any = true;
+            }
+            queued = queued || route.queue->Size() > 0;
+        }
+        if (any) {
+            idle = 0;
+            continue;
+        }
+        if (router->stopping.load(std::memory_order_acquire) && !queued) return;
+
+        // Block 2: spin a little, then park until a dispatch signals new work
+        if (++idle < 256) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(router->sleepMutex);
+        router->sleepers.fetch_add(1, std::memory_order_seq_cst);
+        if (!router->stopping.load(std::memory_order_acquire)) {
+            router->wake.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        router->sleepers.fetch_sub(1, std::memory_order_relaxed);
+        idle = 0;
+    }
+}
+
+// Allocate the queues and copy buffers, start the workers
+inline void MailslotRouterStart(MailslotRouter& router, const MailslotRouterConfig& config,
+                                uint32_t maxMessageSize, MailslotRouteHandler handler) {
+    router.config = config;
+    if (router.config.workers == 0) router.config.workers = 1;
+    router.handler = handler;
+    router.pool.reset(new MailslotPool(config.poolBlocks, maxMessageSize));
+    if (config.prefault) router.pool->Prefault();
+    for (auto& route : router.routes) {
+        if (!route->drop) route->queue.reset(new MailslotBoundedQueue<MailslotRoutedMessage>(config.queueDepth));
+    }
+    router.stopping.store(false);
+    uint32_t workers = std::min<uint32_t>(router.config.workers, (uint32_t)router.routes.size());
+    for (uint32_t i = 0; i < workers; i++) router.workers.emplace_back();
+    for (uint32_t i = 0; i < workers; i++) router.workers[i] = std::thread(MailslotRouterWorker, &router, i);
+}
+
+// Match one message and queue it on its route. A message already held in a
+// pooled buffer (whole, e.g. reassembled) is passed on without a copy.
+// Returns false when it was dropped (drop route, full queue, no buffer).
+inline bool MailslotRouterDispatch(MailslotRouter& router, uint32_t type, const char* data, uint32_t length,
+                                   MailslotMessageView* whole = nullptr) {
+    uint32_t index = MailslotRouterMatch(router, type, data, length);
+    MailslotRoute& route = *router.routes[index];
+    route.matched.fetch_add(1, std::memory_order_relaxed);
+    route.bytes.fetch_add(length, std::memory_order_relaxed);
+    if (route.drop) return false;
+
+    MailslotPoolBlock* block = nullptr;
+    if (whole != nullptr && *whole && whole->Data() == data && whole->Length() == length) {
+        block = whole->Detach();
+    } else if (length <= router.pool->Capacity() && (block = router.pool->AcquireBlock()) != nullptr) {
+        memcpy(block->Data(), data, length);
+        block->length = length;
+    }
+    if (block == nullptr) {
+        route.overflow.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (!route.queue->TryPush(MailslotRoutedMessage{ block, type })) {
+        route.overflow.fetch_add(1, std::memory_order_relaxed);
+        MailslotMessageView release(block);
+        return false;
+    }
+    uint64_t depth = route.queue->Size();
+    if (depth > route.maxDepth.load(std::memory_order_relaxed)) route.maxDepth.store(depth, std::memory_order_relaxed);
+    if (router.sleepers.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(router.sleepMutex);
+        router.wake.notify_all();
+    }
+    return true;
+}
+
+// Let the workers drain every queue, then join them
+inline void MailslotRouterStop(MailslotRouter& router) {
+    router.stopping.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(router.sleepMutex);
+        router.wake.notify_all();
+    }
+    for (std::thread& worker : router.workers) worker.join();
+    router.workers.clear();
+}
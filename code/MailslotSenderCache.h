@@ -0,0 +1,161 @@
+#pragma once
+
+// ------------------------------
+// MailslotSenderCache: open sender endpoints kept across sends
+// Opening a slot (CreateFile / socket + connect / ring mapping) costs more
+// than the write itself, so repeated sends to the same slot reuse one open
+// sender, keyed by slot path.
+// - Stale senders (server restarted or gone: MAILSLOT_ERROR_NOT_FOUND,
+//   MAILSLOT_ERROR_BROKEN_PIPE) are closed and reopened once, transparently.
+// - A slot that cannot be reopened backs off exponentially; sends during
+//   the backoff fail at once with the last error, without a syscall.
+// - At most `capacity` slots stay open; the least recently used is closed.
+// Thread-safe: the map is locked only for lookup, each slot's sends are
+// serialized by its own lock, and an evicted sender closes when its last
+// user is done with it.
+// ------------------------------
+
+#include "MailslotTransport.h"
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct MailslotSenderCacheConfig {
+    uint32_t capacity = 64;               // open senders (file descriptors / handles)
+    MailslotMode mode = MAILSLOT_MODE_KERNEL;
+    uint32_t backoffMinMs = 10;           // first retry delay after a failed open
+    uint32_t backoffMaxMs = 1000;         // delay cap (doubles per failure)
+};
+
+struct MailslotCachedSender {
+    std::string name;
+    std::mutex lock;                      // one send / reopen at a time
+    MailslotSender sender;
+    bool open = false;
+    uint32_t failures = 0;                // consecutive failed opens
+    uint64_t retryNs = 0;                 // no open attempt before this
+    MailslotErrorCode lastError = 0;
+
+    ~MailslotCachedSender() {
+        if (open) MailslotClose(sender);
+    }
+};
+
+struct MailslotSenderCache {
+    MailslotSenderCacheConfig config;
+    std::mutex lock;
+    std::list<std::shared_ptr<MailslotCachedSender>> lru;   // front — most recent
+    std::unordered_map<std::string, std::list<std::shared_ptr<MailslotCachedSender>>::iterator> index;
+
+    std::atomic<uint64_t> hits{0};        // sends on an already open sender
+    std::atomic<uint64_t> opens{0};       // successful opens (first use or reopen)
+    std::atomic<uint64_t> reopens{0};     // stale senders replaced
+    std::atomic<uint64_t> backoffs{0};    // sends refused during a backoff
+    std::atomic<uint64_t> evictions{0};   // senders closed by the LRU bound
+};
+
+inline void MailslotSenderCacheInit(MailslotSenderCache& cache, const MailslotSenderCacheConfig& config) {
+    cache.config = config;
+    if (cache.config.capacity == 0) cache.config.capacity = 1;
+}
+
+// Entry for a slot (created on first use), moved to the LRU front
+inline std::shared_ptr<MailslotCachedSender> MailslotSenderCacheEntry(MailslotSenderCache& cache,
+                                                                      const std::string& name) {
+    std::lock_guard<std::mutex> guard(cache.lock);
+    auto found = cache.index.find(name);
+    if (found != cache.index.end()) {
+        cache.lru.splice(cache.lru.begin(), cache.lru, found->second);
+        return *found->second;
+    }
+    std::shared_ptr<MailslotCachedSender> entry = std::make_shared<MailslotCachedSender>();
+    entry->name = name;
+    cache.lru.push_front(entry);
+    cache.index[name] = cache.lru.begin();
+    while (cache.lru.size() > cache.config.capacity) {
+        cache.index.erase(cache.lru.back()->name);
+        cache.lru.pop_back();             // closes once no send is using it
+        cache.evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    return entry;
+}
+
+inline bool MailslotSenderCacheStale(MailslotErrorCode error) {
+    return error == MAILSLOT_ERROR_NOT_FOUND || error == MAILSLOT_ERROR_BROKEN_PIPE;
+}
+
+// Open (or reopen) with backoff; entry lock held
+inline bool MailslotSenderCacheOpen(MailslotSenderCache& cache, MailslotCachedSender& entry) {
+    uint64_t nowNs = MailslotNowNs();
+    if (entry.failures > 0 && nowNs < entry.retryNs) {
+        cache.backoffs.fetch_add(1, std::memory_order_relaxed);
+        MailslotSetLastError(entry.lastError);
+        return false;
+    }
+    entry.sender = MailslotSender();
+    if (!MailslotOpenSender(entry.sender, entry.name, cache.config.mode)) {
+        entry.lastError = MailslotLastError();
+        uint64_t delayMs = (uint64_t)cache.config.backoffMinMs << std::min<uint32_t>(entry.failures, 16);
+        entry.retryNs = nowNs + std::min<uint64_t>(delayMs, cache.config.backoffMaxMs) * 1000000ull;
+        entry.failures++;
+        MailslotSetLastError(entry.lastError);
+        return false;
+    }
+    entry.open = true;
+    entry.failures = 0;
+    cache.opens.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Send one message to name through the cache. *operation names the failed
+// step ("CreateFile" / "WriteFile"); the error is in MailslotLastError.
+inline bool MailslotCachedSend(MailslotSenderCache& cache, const std::string& name, const void* data,
+                               uint32_t length, uint32_t* bytesWritten, const char** operation = nullptr) {
+    const char* ignored = nullptr;
+    if (operation == nullptr) operation = &ignored;
+    *bytesWritten = 0;
+    std::shared_ptr<MailslotCachedSender> entry = MailslotSenderCacheEntry(cache, name);
+    std::lock_guard<std::mutex> guard(entry->lock);
+
+    // Block 1: reuse the open sender
+    bool reused = entry->open;
+    if (!reused && !MailslotSenderCacheOpen(cache, *entry)) {
+        *operation = "CreateFile";
+        return false;
+    }
+    if (MailslotSend(entry->sender, data, length, bytesWritten)) {
+        if (reused) cache.hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    MailslotErrorCode error = MailslotLastError();
+    if (!reused || !MailslotSenderCacheStale(error)) {
+        *operation = "WriteFile";
+        MailslotSetLastError(error);
+        return false;
+    }
+
+    // Block 2: stale sender (server restarted) — reopen once and retry
+    MailslotClose(entry->sender);
+    entry->open = false;
+    cache.reopens.fetch_add(1, std::memory_order_relaxed);
+    if (!MailslotSenderCacheOpen(cache, *entry)) {
+        *operation = "CreateFile";
+        return false;
+    }
+    if (!MailslotSend(entry->sender, data, length, bytesWritten)) {
+        *operation = "WriteFile";
+        return false;
+    }
+    return true;
+}
+
+// Close every cached sender (senders in use close when their send ends)
+inline void MailslotSenderCacheClear(MailslotSenderCache& cache) {
+    std::lock_guard<std::mutex> guard(cache.lock);
+    cache.index.clear();
+    cache.lru.clear();
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+// ------------------------------
+// MailslotSlot: compile-time configured server slot
+// MailslotSlot<MaxMessage, TimeoutPolicy, Handler> fixes the slot's shape
+// in the type instead of in copied sources:
+// - MaxMessage    — nMaxMessage; the receive buffer is a member array of
+//                   exactly MaxMessage + 1 bytes (room for a trailing '\0'),
+//                   and the size check against it is a constant
+// - TimeoutPolicy — lReadTimeout (MailslotFixedTimeout<MS> or
+//                   MailslotWaitForever) and how many consecutive timeouts
+//                   end MailslotSlot::Run
+// - Handler       — called inline for every message:
+//                   bool handler(char* data, uint32_t length)
+//                   data[length] is writable; return false to stop Run
+//
+// Tuned variants are one typedef each, e.g.
+//   typedef MailslotSlot<64, MailslotFixedTimeout<180000>, MailslotPrintHandler> TelemetrySlot;
+// and MailslotSingleMessageServer<Slot>() is the whole ServerMS program.
+// ------------------------------
+
+#include "MailslotFrame.h"
+#include "MailslotTransport.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// Largest MaxMessage accepted (a local mailslot's practical limit)
+static const uint32_t kSlotMaxMessageLimit = 64 * 1024;
+
+// ------------------------------
+// Timeout policies
+// ------------------------------
+
+// Fixed read timeout; Run ends after Timeouts consecutive timeouts
+template <uint32_t TimeoutMs, uint32_t Timeouts = 1>
+struct MailslotFixedTimeout {
+    static constexpr uint32_t kReadTimeoutMs = TimeoutMs;
+    static constexpr uint32_t kTimeoutsToStop = Timeouts;
+};
+
+// Block until a message arrives; Run ends only on an error or the handler
+struct MailslotWaitForever {
+    static constexpr uint32_t kReadTimeoutMs = MAILSLOT_WAIT_FOREVER;
+    static constexpr uint32_t kTimeoutsToStop = 1;
+};
+
+// ------------------------------
+// Handlers
+// ------------------------------
+
+// Prints each message; binary frames (MailslotFrame.h) with their header fields
+struct MailslotPrintHandler {
+    bool operator()(char* data, uint32_t length) const {
+        MailslotFrameView frame;
+        MailslotFrameStatus status = MailslotFrameDecode(data, length, &frame);
+        if (status == MAILSLOT_FRAME_OK) {
+            std::cout << "Received frame (" << length << " bytes): sender " << frame.header->senderId
+                      << ", sequence " << frame.header->sequence << ", type " << frame.header->type
+                      << ", payload " << frame.payloadLength << " bytes:" << std::endl;
+            std::cout.write(frame.payload, frame.payloadLength);   // payload may be binary
+            std::cout << std::endl;
+        } else if (status != MAILSLOT_FRAME_NOT_FRAMED) {
+            std::cout << "Damaged frame (" << length << " bytes): "
+                      << (status == MAILSLOT_FRAME_BAD_CHECKSUM ? "bad checksum"
+                          : status == MAILSLOT_FRAME_TRUNCATED  ? "truncated"
+                                                                : "unknown version") << std::endl;
+        } else if (length > 0) {
+            data[length] = '\0';                   // Ensure C-string termination
+            std::cout << "Received message (" << length << " bytes):" << std::endl;
+            std::cout << data << std::endl;        // Print payload
+        } else {
+            std::cout << "Empty message received" << std::endl;
+        }
+        return true;
+    }
+};
+
+// ------------------------------
+// Slot
+// ------------------------------
+template <uint32_t MaxMessage, class TimeoutPolicy, class Handler>
+class MailslotSlot {
+public:
+    static_assert(MaxMessage > 0, "MailslotSlot needs a bounded message size");
+    static_assert(MaxMessage <= kSlotMaxMessageLimit, "MaxMessage above the mailslot limit");
+    static_assert(TimeoutPolicy::kTimeoutsToStop > 0, "TimeoutPolicy must stop after at least one timeout");
+
+    static constexpr uint32_t kMaxMessage = MaxMessage;
+    static constexpr uint32_t kReadTimeoutMs = TimeoutPolicy::kReadTimeoutMs;
+
+    explicit MailslotSlot(Handler handler = Handler()) : handler_(handler) {}
+    ~MailslotSlot() { Close(); }
+
+    MailslotSlot(const MailslotSlot&) = delete;
+    MailslotSlot& operator=(const MailslotSlot&) = delete;
+
+    // Create the server endpoint (nMaxMessage = MaxMessage, lReadTimeout from the policy)
+    bool Create(const std::string& name, MailslotMode mode = MAILSLOT_MODE_KERNEL) {
+        created_ = MailslotCreate(server_, name, MaxMessage, kReadTimeoutMs, mode);
+        return created_;
+    }
+
+    // Wait for one message and pass it to the handler.
+    // false — nothing handled: MailslotLastError is MAILSLOT_ERROR_TIMEOUT or a read error;
+    // *keepGoing (optional) receives the handler's result
+    bool ReceiveOne(bool* keepGoing = nullptr) {
+        uint32_t bytesRead = 0;
+        // MaxMessage bytes offered: larger messages never reach the buffer
+        // (the slot rejects them), so the last byte is always free for '\0'
+        if (!MailslotReceive(server_, buffer_, MaxMessage, &bytesRead, kReadTimeoutMs)) return false;
+        bool more = handler_(buffer_, bytesRead);
+        if (keepGoing != nullptr) *keepGoing = more;
+        return true;
+    }
+
+    // Hand messages to the handler until it returns false, maxMessages were
+    // handled (0 — no limit), a read error, or the policy's run of timeouts.
+    // Returns the number of messages handled.
+    uint64_t Run(uint64_t maxMessages = 0) {
+        uint64_t handled = 0;
+        uint32_t timeouts = 0;
+        while (maxMessages == 0 || handled < maxMessages) {
+            bool keepGoing = true;
+            if (!ReceiveOne(&keepGoing)) {
+                if (MailslotLastError() != MAILSLOT_ERROR_TIMEOUT) break;
+                if (++timeouts >= TimeoutPolicy::kTimeoutsToStop) break;
+                continue;
+            }
+            timeouts = 0;
+            handled++;
+            if (!keepGoing) break;
+        }
+        return handled;
+    }
+
+    void Close() {
+        if (created_) MailslotClose(server_);
+        created_ = false;
+    }
+
+    MailslotServer& Server() { return server_; }
+    Handler& GetHandler() { return handler_; }
+
+private:
+    MailslotServer server_;
+    Handler handler_;
+    bool created_ = false;
+    alignas(64) char buffer_[MaxMessage + 1];      // sized by the type, no heap
+};
+
+// ------------------------------
+// ServerMS program for any slot type: create \\.\mailslot\<slotName>,
+// wait for a single message, hand it to the handler and exit
+// ------------------------------
+template <class Slot>
+int MailslotSingleMessageServer(const char* slotName) {
+    MailslotInitConsole();                         // Console code page: Windows-1251
+
+    // Block 1: Create Mailslot
+    // Local name format — \\.\mailslot\<Name>; visible on the current machine.
+    // Max message size and read timeout come from the slot type.
+    std::string mailslotName = MailslotLocalName(slotName);
+    Slot slot;
+    if (!slot.Create(mailslotName)) {
+        HandleMailslotError("CreateMailslot");
+        return 1;
+    }
+
+    std::cout << "Mailslot created" << std::endl;
+    std::cout << "Max message size: " << Slot::kMaxMessage << " bytes" << std::endl;
+    std::cout << "Waiting for client message..." << std::endl;
+
+    // Block 2: Read one message and process it in the slot's handler
+    if (!slot.ReceiveOne()) {
+        if (MailslotLastError() == MAILSLOT_ERROR_TIMEOUT) {   // Special case: read timeout
+            std::cout << "Message wait timeout (" << Slot::kReadTimeoutMs / 1000 << " s)" << std::endl;
+        } else {
+            HandleMailslotError("ReadFile");
+        }
+        return 1;                                  // Slot closes itself
+    }
+
+    slot.Close();                                  // Close server endpoint
+    std::cout << "Server shutting down." << std::endl;
+    return 0;
+}
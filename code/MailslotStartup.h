@@ -0,0 +1,121 @@
+#pragma once
+
+// ------------------------------
+// MailslotStartup: pre-warmed server start
+// A freshly started server takes page faults, lazy initialisation and
+// cache misses on its first messages. A warm start moves that cost before
+// traffic is accepted:
+// - buffers and pools are faulted in (MailslotPrefault, MailslotPool::Prefault)
+// - the receive thread is pinned to one CPU (MailslotPinThread), so its
+//   caches and memory stay local
+// - memory is optionally locked (MailslotLockMemory): mlockall on Linux, a
+//   hard working-set minimum on Windows — prefaulted pages stay resident
+// - readiness is published only after all of that (MailslotReadyFile,
+//   MailslotReadyFd), so orchestrators can hold traffic until the server
+//   is warm
+// ------------------------------
+
+#include "MailslotPlatform.h"
+#include <cstdio>
+#include <string>
+
+#ifdef _WIN32
+#include <psapi.h>
+#else
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#endif
+
+// Pin the calling thread to one CPU
+inline bool MailslotPinThread(uint32_t cpu) {
+#ifdef _WIN32
+    if (cpu >= sizeof(DWORD_PTR) * 8) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return false;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#else
+    if (cpu >= CPU_SETSIZE) {
+        errno = EINVAL;
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#endif
+}
+
+// Keep the process's memory resident.
+// Linux: mlockall of current and future mappings (bytes is ignored; needs
+// CAP_IPC_LOCK or a large enough RLIMIT_MEMLOCK).
+// Windows: hard minimum working set of bytes (plus headroom for code and stacks).
+inline bool MailslotLockMemory(size_t bytes) {
+#ifdef _WIN32
+    SIZE_T minimum = bytes + (32u << 20);
+    return SetProcessWorkingSetSizeEx(GetCurrentProcess(), minimum, minimum * 2,
+                                      QUOTA_LIMITS_HARDWS_MIN_ENABLE | QUOTA_LIMITS_HARDWS_MAX_DISABLE) != FALSE;
+#else
+    (void)bytes;
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#endif
+}
+
+// Page faults taken by this process so far (minor faults on Linux)
+inline uint64_t MailslotPageFaults() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PageFaultCount;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return (uint64_t)usage.ru_minflt + (uint64_t)usage.ru_majflt;
+#endif
+}
+
+// Readiness file: written to PATH.tmp and renamed, so a watcher never sees
+// a partial file. Holds the process id, the slot and the startup time.
+inline bool MailslotReadyFile(const std::string& path, const std::string& slotName, double startupMs) {
+    std::string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "w");
+    if (file == NULL) return false;
+#ifdef _WIN32
+    unsigned long pid = GetCurrentProcessId();
+#else
+    unsigned long pid = (unsigned long)getpid();
+#endif
+    bool ok = fprintf(file, "pid %lu\nslot %s\nstartup_ms %.3f\n", pid, slotName.c_str(), startupMs) > 0;
+    ok = fclose(file) == 0 && ok;
+#ifdef _WIN32
+    ok = ok && MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    ok = ok && rename(temporary.c_str(), path.c_str()) == 0;
+#endif
+    if (!ok) remove(temporary.c_str());
+    return ok;
+}
+
+// Remove the readiness file on shutdown (the server no longer accepts traffic)
+inline void MailslotReadyClear(const std::string& path) {
+    if (!path.empty()) remove(path.c_str());
+}
+
+// Readiness descriptor inherited from the parent (a pipe): write "READY=1\n"
+// and close it, so the parent's read returns once the server is warm.
+// On Windows fd is an inheritable handle value.
+inline bool MailslotReadyFd(intptr_t fd) {
+    static const char kReady[] = "READY=1\n";
+#ifdef _WIN32
+    HANDLE handle = (HANDLE)fd;
+    DWORD written = 0;
+    bool ok = WriteFile(handle, kReady, sizeof(kReady) - 1, &written, NULL) && written == sizeof(kReady) - 1;
+    CloseHandle(handle);
+    return ok;
+#else
+    bool ok = write((int)fd, kReady, sizeof(kReady) - 1) == (ssize_t)(sizeof(kReady) - 1);
+    close((int)fd);
+    return ok;
+#endif
+}
@@ -0,0 +1,357 @@
+#pragma once
+
+// ------------------------------
+// MailslotStats: hot-path counters and histograms for the receive path
+// Every thread that receives gets its own cache-line-aligned block and is
+// its only writer, so recording is a plain relaxed load + store (no locked
+// instructions, no sharing). Readers sum all blocks into a snapshot at any
+// time; a dumper thread can write that snapshot to a file periodically
+// (write to <file>.tmp, then rename — readers never see a torn file).
+//
+// Recorded by the transport (MailslotReceive / MailslotReceiveMany):
+// messages, bytes, read calls, read-call latency, time blocked in reads
+// versus time spent between reads (processing), message sizes, timeouts
+// and receive errors by code. Two clock reads per receive call, so batched
+// receives pay a few nanoseconds per message.
+// Build with -DMAILSLOT_STATS_DISABLED to compile the recording out.
+// ------------------------------
+
+#include "MailslotPlatform.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static const int kStatsLatencyBuckets = 40;   // log2(ns): 1 ns .. ~9 min
+static const int kStatsSizeBuckets = 24;      // log2(bytes): 1 B .. 8 MB
+static const int kStatsErrorCodes = 8;        // distinct error codes per thread
+static const int kStatsMaxThreads = 64;       // the last block is shared by the overflow
+
+// ------------------------------
+// Per-thread block
+// ------------------------------
+struct alignas(64) MailslotThreadStats {
+    std::atomic<bool> claimed{false};
+    bool shared = false;                      // overflow block: atomic adds
+
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> readCalls{0};
+    std::atomic<uint64_t> timeouts{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> blockedNs{0};       // inside receive calls
+    std::atomic<uint64_t> processingNs{0};    // between receive calls
+    uint64_t lastReturnNs = 0;                // owner only
+
+    std::atomic<uint64_t> readLatency[kStatsLatencyBuckets];
+    std::atomic<uint64_t> messageSize[kStatsSizeBuckets];
+    std::atomic<int64_t> errorCode[kStatsErrorCodes];    // -1 — free entry
+    std::atomic<uint64_t> errorCount[kStatsErrorCodes];  // the last entry also takes overflow
+
+    MailslotThreadStats() {
+        for (int i = 0; i < kStatsLatencyBuckets; i++) readLatency[i].store(0, std::memory_order_relaxed);
+        for (int i = 0; i < kStatsSizeBuckets; i++) messageSize[i].store(0, std::memory_order_relaxed);
+        for (int i = 0; i < kStatsErrorCodes; i++) {
+            errorCode[i].store(-1, std::memory_order_relaxed);
+            errorCount[i].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+inline MailslotThreadStats* MailslotStatsBlocks() {
+    static MailslotThreadStats blocks[kStatsMaxThreads];
+    // The overflow block is marked once, before any thread can reach it
+    static bool overflowMarked = (blocks[kStatsMaxThreads - 1].shared = true);
+    (void)overflowMarked;
+    return blocks;
+}
+
+// The calling thread's block (claimed on first use, kept for the process)
+inline MailslotThreadStats& MailslotStatsLocal() {
+    thread_local MailslotThreadStats* local = nullptr;
+    if (local == nullptr) {
+        MailslotThreadStats* blocks = MailslotStatsBlocks();
+        for (int i = 0; i < kStatsMaxThreads - 1 && local == nullptr; i++) {
+            bool expected = false;
+            if (blocks[i].claimed.compare_exchange_strong(expected, true)) local = &blocks[i];
+        }
+        if (local == nullptr) {
+            local = &blocks[kStatsMaxThreads - 1];
+            local->claimed.store(true);
+        }
+    }
+    return *local;
+}
+
+inline int MailslotStatsLog2(uint64_t value) {
+    if (value == 0) return 0;
+#ifdef _MSC_VER
+    unsigned long msb;
+    _BitScanReverse64(&msb, value);
+    return (int)msb;
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+// Single-writer add: no read-modify-write unless the block is shared
+inline void MailslotStatsAdd(const MailslotThreadStats& stats, std::atomic<uint64_t>& counter, uint64_t value) {
+    if (stats.shared) {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    } else {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+}
+
+// ------------------------------
+// Recording (called by the transport)
+// ------------------------------
+#ifndef MAILSLOT_STATS_DISABLED
+
+// Start of a receive call; returns the entry timestamp
+inline uint64_t MailslotStatsReadBegin() {
+    MailslotThreadStats& stats = MailslotStatsLocal();
+    uint64_t now = MailslotNowNs();
+    if (stats.lastReturnNs != 0) MailslotStatsAdd(stats, stats.processingNs, now - stats.lastReturnNs);
+    return now;
+}
+
+// End of a receive call that returned `messages` messages of `bytes` total
+inline void MailslotStatsReadEnd(uint64_t beginNs, uint32_t messages, uint64_t bytes) {
+    MailslotThreadStats& stats = MailslotStatsLocal();
+    uint64_t now = MailslotNowNs();
+    uint64_t elapsed = now - beginNs;
+    stats.lastReturnNs = now;
+    MailslotStatsAdd(stats, stats.readCalls, 1);
+    MailslotStatsAdd(stats, stats.blockedNs, elapsed);
+    MailslotStatsAdd(stats, stats.readLatency[std::min(MailslotStatsLog2(elapsed), kStatsLatencyBuckets - 1)], 1);
+    if (messages > 0) {
+        MailslotStatsAdd(stats, stats.messages, messages);
+        MailslotStatsAdd(stats, stats.bytes, bytes);
+    }
+}
+
+inline void MailslotStatsMessageSize(uint32_t length) {
+    MailslotThreadStats& stats = MailslotStatsLocal();
+    MailslotStatsAdd(stats, stats.messageSize[std::min(MailslotStatsLog2(length), kStatsSizeBuckets - 1)], 1);
+}
+
+// End of a readiness wait (epoll / IOCP) that began with MailslotStatsReadBegin:
+// blocked time only, the reads that follow are recorded on their own
+inline void MailslotStatsWaitEnd(uint64_t beginNs) {
+    MailslotThreadStats& stats = MailslotStatsLocal();
+    uint64_t now = MailslotNowNs();
+    stats.lastReturnNs = now;
+    MailslotStatsAdd(stats, stats.blockedNs, now - beginNs);
+}
+
+// One message completed outside the receive calls (IOCP completion)
+inline void MailslotStatsMessage(uint32_t length) {
+    MailslotThreadStats& stats = MailslotStatsLocal();
+    MailslotStatsAdd(stats, stats.messages, 1);
+    MailslotStatsAdd(stats, stats.bytes, length);
+    MailslotStatsMessageSize(length);
+}
+
+inline void MailslotStatsTimeout() {
+    MailslotThreadStats& stats = MailslotStatsLocal();
+    MailslotStatsAdd(stats, stats.timeouts, 1);
+}
+
+inline void MailslotStatsError(MailslotErrorCode error) {
+    MailslotThreadStats& stats = MailslotStatsLocal();
+    MailslotStatsAdd(stats, stats.errors, 1);
+    int entry = kStatsErrorCodes - 1;         // overflow lands in the last entry
+    for (int i = 0; i < kStatsErrorCodes; i++) {
+        int64_t code = stats.errorCode[i].load(std::memory_order_relaxed);
+        if (code == (int64_t)error) { entry = i; break; }
+        if (code == -1) {
+            stats.errorCode[i].store((int64_t)error, std::memory_order_relaxed);
+            entry = i;
+            break;
+        }
+    }
+    MailslotStatsAdd(stats, stats.errorCount[entry], 1);
+}
+
+// Failed receive call: timeouts and errors are counted separately
+inline void MailslotStatsReadFailed(MailslotErrorCode error) {
+    if (error == MAILSLOT_ERROR_TIMEOUT) {
+        MailslotStatsTimeout();
+    } else {
+        MailslotStatsError(error);
+    }
+}
+
+#else
+inline uint64_t MailslotStatsReadBegin() { return 0; }
+inline void MailslotStatsReadEnd(uint64_t, uint32_t, uint64_t) {}
+inline void MailslotStatsMessageSize(uint32_t) {}
+inline void MailslotStatsWaitEnd(uint64_t) {}
+inline void MailslotStatsMessage(uint32_t) {}
+inline void MailslotStatsTimeout() {}
+inline void MailslotStatsError(MailslotErrorCode) {}
+inline void MailslotStatsReadFailed(MailslotErrorCode) {}
+#endif
+
+// ------------------------------
+// Snapshot (any thread, any time)
+// ------------------------------
+struct MailslotStatsSnapshot {
+    uint64_t timestampNs;                     // MailslotNowNs at the snapshot
+    uint32_t threads;                         // blocks in use
+    uint64_t messages;
+    uint64_t bytes;
+    uint64_t readCalls;
+    uint64_t timeouts;
+    uint64_t errors;
+    uint64_t blockedNs;
+    uint64_t processingNs;
+    uint64_t readLatency[kStatsLatencyBuckets];
+    uint64_t messageSize[kStatsSizeBuckets];
+    uint32_t errorCodes;                      // used entries below
+    int64_t errorCode[kStatsErrorCodes * 2];
+    uint64_t errorCount[kStatsErrorCodes * 2];
+};
+
+inline void MailslotStatsTake(MailslotStatsSnapshot& snapshot) {
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.timestampNs = MailslotNowNs();
+    MailslotThreadStats* blocks = MailslotStatsBlocks();
+    for (int b = 0; b < kStatsMaxThreads; b++) {
+        MailslotThreadStats& stats = blocks[b];
+        if (!stats.claimed.load(std::memory_order_acquire)) continue;
+        snapshot.threads++;
+        snapshot.messages += stats.messages.load(std::memory_order_relaxed);
+        snapshot.bytes += stats.bytes.load(std::memory_order_relaxed);
+        snapshot.readCalls += stats.readCalls.load(std::memory_order_relaxed);
+        snapshot.timeouts += stats.timeouts.load(std::memory_order_relaxed);
+        snapshot.errors += stats.errors.load(std::memory_order_relaxed);
+        snapshot.blockedNs += stats.blockedNs.load(std::memory_order_relaxed);
+        snapshot.processingNs += stats.processingNs.load(std::memory_order_relaxed);
+        for (int i = 0; i < kStatsLatencyBuckets; i++) snapshot.readLatency[i] += stats.readLatency[i].load(std::memory_order_relaxed);
+        for (int i = 0; i < kStatsSizeBuckets; i++) snapshot.messageSize[i] += stats.messageSize[i].load(std::memory_order_relaxed);
+        for (int i = 0; i < kStatsErrorCodes; i++) {
+            int64_t code = stats.errorCode[i].load(std::memory_order_relaxed);
+            if (code == -1) break;
+            uint64_t count = stats.errorCount[i].load(std::memory_order_relaxed);
+            uint32_t entry = 0;
+            while (entry < snapshot.errorCodes && snapshot.errorCode[entry] != code) entry++;
+            if (entry == snapshot.errorCodes) {
+                if (entry == (uint32_t)kStatsErrorCodes * 2) entry--;       // merge overflow into the last
+                else snapshot.errorCode[snapshot.errorCodes++] = code;
+            }
+            snapshot.errorCount[entry] += count;
+        }
+    }
+}
+
+// Text form: one "key value" per line, histograms as "key bucket:count ..."
+// (bucket = upper bound, 2^(i+1) - 1). Returns the formatted length.
+inline size_t MailslotStatsFormat(const MailslotStatsSnapshot& snapshot, char* buffer, size_t size) {
+    size_t used = 0;
+    auto append = [&](const char* format, unsigned long long a, unsigned long long b) {
+        if (used >= size) return;
+        int written = snprintf(buffer + used, size - used, format, a, b);
+        if (written > 0) used = std::min(size - 1, used + (size_t)written);
+    };
+    append("threads %llu\n", snapshot.threads, 0);
+    append("messages %llu\n", snapshot.messages, 0);
+    append("bytes %llu\n", snapshot.bytes, 0);
+    append("read_calls %llu\n", snapshot.readCalls, 0);
+    append("timeouts %llu\n", snapshot.timeouts, 0);
+    append("errors %llu\n", snapshot.errors, 0);
+    append("blocked_ns %llu\n", snapshot.blockedNs, 0);
+    append("processing_ns %llu\n", snapshot.processingNs, 0);
+    append("read_latency_ns", 0, 0);
+    for (int i = 0; i < kStatsLatencyBuckets; i++) {
+        if (snapshot.readLatency[i] != 0) append(" %llu:%llu", (2ULL << i) - 1, snapshot.readLatency[i]);
+    }
+    append("\nmessage_size", 0, 0);
+    for (int i = 0; i < kStatsSizeBuckets; i++) {
+        if (snapshot.messageSize[i] != 0) append(" %llu:%llu", (2ULL << i) - 1, snapshot.messageSize[i]);
+    }
+    append("\nerror_codes", 0, 0);
+    for (uint32_t i = 0; i < snapshot.errorCodes; i++) {
+        append(" %llu:%llu", (unsigned long long)snapshot.errorCode[i], snapshot.errorCount[i]);
+    }
+    append("\n", 0, 0);
+    return used;
+}
+
+// Write the current snapshot to path (atomically replaced)
+inline bool MailslotStatsWriteFile(const std::string& path) {
+    MailslotStatsSnapshot snapshot;
+    MailslotStatsTake(snapshot);
+    char text[4096];
+    size_t length = MailslotStatsFormat(snapshot, text, sizeof(text));
+
+    std::string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (file == NULL) return false;
+    bool ok = fwrite(text, 1, length, file) == length;
+    ok = fclose(file) == 0 && ok;
+#ifdef _WIN32
+    ok = ok && MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    ok = ok && rename(temporary.c_str(), path.c_str()) == 0;
+#endif
+    return ok;
+}
+
+// ------------------------------
+// Periodic dump file
+// ------------------------------
+struct MailslotStatsDumper {
+    std::string path;
+    uint32_t intervalMs = 1000;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+inline void MailslotStatsDumperStart(MailslotStatsDumper& dumper, const std::string& path, uint32_t intervalMs) {
+    dumper.path = path;
+    dumper.intervalMs = intervalMs == 0 ? 1000 : intervalMs;
+    dumper.stopping = false;
+    dumper.thread = std::thread([&dumper]() {
+        std::unique_lock<std::mutex> lock(dumper.mutex);
+        while (!dumper.stopping) {
+            dumper.wake.wait_for(lock, std::chrono::milliseconds(dumper.intervalMs));
+            MailslotStatsWriteFile(dumper.path);
+        }
+    });
+}
+
+// Stop the dumper; the file keeps the final snapshot
+inline void MailslotStatsDumperStop(MailslotStatsDumper& dumper) {
+    if (!dumper.thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(dumper.mutex);
+        dumper.stopping = true;
+    }
+    dumper.wake.notify_all();
+    dumper.thread.join();
+}
+
+// One-line summary for a server's shutdown message
+inline void MailslotStatsPrintSummary(std::ostream& out) {
+    MailslotStatsSnapshot snapshot;
+    MailslotStatsTake(snapshot);
+    out << "Stats: " << snapshot.messages << " messages, " << snapshot.bytes << " bytes in "
+        << snapshot.readCalls << " read calls; blocked " << snapshot.blockedNs / 1000000
+        << " ms, processing " << snapshot.processingNs / 1000000 << " ms; timeouts "
+        << snapshot.timeouts << ", errors " << snapshot.errors;
+    for (uint32_t i = 0; i < snapshot.errorCodes; i++) {
+        out << (i == 0 ? " (" : ", ") << "code " << snapshot.errorCode[i] << ": " << snapshot.errorCount[i];
+    }
+    out << (snapshot.errorCodes > 0 ? ")" : "") << std::endl;
+}
@@ -0,0 +1,510 @@
+#pragma once
+
+// ------------------------------
+// MailslotTransport: portable mailslot transport shared by servers and clients
+// One interface for creating a slot, opening a sender, sending, receiving
+// with timeout and querying the max message size.
+//
+// Backends:
+// - Windows: CreateMailslot / CreateFile / ReadFile / WriteFile
+// - Linux:   AF_UNIX datagram sockets in the abstract namespace.
+//            One datagram == one message, boundaries are preserved, and the
+//            socket disappears together with its owner (like a mailslot).
+//
+// Slot names use the Windows form on every platform:
+//   \\.\mailslot\Box       — local slot
+//   \\HOST\mailslot\Box    — remote slot (Windows only; on Linux HOST must
+//                            resolve to the local machine name)
+//
+// Either side may instead select MAILSLOT_MODE_SHARED_MEMORY for local
+// traffic (see MailslotRing.h); server and senders must agree on the mode.
+// ------------------------------
+
+#include "MailslotPlatform.h"
+#include "MailslotRing.h"
+#include "MailslotStats.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Backend selection for a slot
+// MAILSLOT_MODE_KERNEL        — native mailslot / datagram socket (local and remote)
+// MAILSLOT_MODE_SHARED_MEMORY — MailslotRing segment (same host only)
+enum MailslotMode {
+    MAILSLOT_MODE_KERNEL,
+    MAILSLOT_MODE_SHARED_MEMORY
+};
+
+// One entry of a batched receive: caller-owned storage + received length
+struct MailslotMessage {
+    char* buffer;                     // destination buffer
+    uint32_t capacity;                // buffer size (bytes)
+    uint32_t length;                  // bytes received
+};
+
+#define MAILSLOT_BATCH_MAX 64         // messages per recvmmsg call
+
+#ifndef _WIN32
+// Mailslot name -> abstract socket address ("\0mailslot/<path>")
+inline bool MailslotSocketAddress(const std::string& name, sockaddr_un* addr, socklen_t* addrLen) {
+    std::string path;
+    if (!MailslotLocalSlotPath(name, &path)) return false;
+    path = "mailslot/" + path;
+    if (path.size() + 1 > sizeof(addr->sun_path)) {
+        errno = MAILSLOT_ERROR_INVALID_PARAMETER;
+        return false;
+    }
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    memcpy(addr->sun_path + 1, path.data(), path.size()); // sun_path[0] == '\0' — abstract
+    *addrLen = (socklen_t)(offsetof(sockaddr_un, sun_path) + 1 + path.size());
+    return true;
+}
+#endif
+
+// ------------------------------
+// Server (receiving) endpoint
+// ------------------------------
+struct MailslotServer {
+    MailslotNativeHandle handle = MAILSLOT_INVALID_HANDLE;
+    std::string name;                 // full mailslot name
+    uint32_t maxMessageSize = 0;      // nMaxMessage
+    uint32_t readTimeoutMs = 0;       // lReadTimeout
+    uint64_t oversizeDropped = 0;     // Linux: datagrams above maxMessageSize
+                                      // (or above a batch buffer's capacity)
+    MailslotMode mode = MAILSLOT_MODE_KERNEL;
+    MailslotRing ring;                // MAILSLOT_MODE_SHARED_MEMORY backend
+};
+
+// Create a server slot
+// maxMessageSize — largest accepted message (bytes), 0 — any size
+// readTimeoutMs  — default MailslotReceive wait (MAILSLOT_WAIT_FOREVER — infinite)
+// mode           — kernel slot or shared-memory ring (ring needs maxMessageSize > 0)
+inline bool MailslotCreate(MailslotServer& server, const std::string& name,
+                           uint32_t maxMessageSize, uint32_t readTimeoutMs,
+                           MailslotMode mode = MAILSLOT_MODE_KERNEL) {
+    server.name = name;
+    server.maxMessageSize = maxMessageSize;
+    server.readTimeoutMs = readTimeoutMs;
+    server.oversizeDropped = 0;
+    server.mode = mode;
+    if (mode == MAILSLOT_MODE_SHARED_MEMORY) {
+        return MailslotRingCreate(server.ring, name, maxMessageSize, MAILSLOT_RING_DEFAULT_CAPACITY);
+    }
+#ifdef _WIN32
+    std::wstring wideName = MailslotWideName(name);
+    server.handle = CreateMailslotW(
+        wideName.c_str(),  // Full local mailslot name
+        maxMessageSize,    // Max message size (bytes)
+        readTimeoutMs,     // Read timeout (ms)
+        NULL               // Default security
+    );
+    return server.handle != INVALID_HANDLE_VALUE;
+#else
+    sockaddr_un addr;
+    socklen_t addrLen = 0;
+    if (!MailslotSocketAddress(name, &addr, &addrLen)) return false;
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    if (bind(fd, (const sockaddr*)&addr, addrLen) != 0) {
+        int error = errno;
+        close(fd);
+        errno = error;                 // EADDRINUSE == MAILSLOT_ERROR_ALREADY_EXISTS
+        return false;
+    }
+    // Deeper kernel queue so bursts queue up instead of blocking senders
+    int receiveBuffer = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+    server.handle = fd;
+    return true;
+#endif
+}
+
+inline uint32_t MailslotMaxMessageSize(const MailslotServer& server) {
+    return server.maxMessageSize;
+}
+
+// Receive one message without recording stats (see MailslotReceive)
+inline bool MailslotReceiveOne(MailslotServer& server, char* buffer, uint32_t bufferSize,
+                               uint32_t* bytesRead, uint32_t timeoutMs) {
+    *bytesRead = 0;
+    if (server.mode == MAILSLOT_MODE_SHARED_MEMORY) {
+        return MailslotRingPop(server.ring, buffer, bufferSize, bytesRead, timeoutMs);
+    }
+#ifdef _WIN32
+    if (timeoutMs != server.readTimeoutMs) {
+        if (!SetMailslotInfo(server.handle, timeoutMs)) return false;
+        server.readTimeoutMs = timeoutMs;
+    }
+    DWORD read = 0;
+    BOOL readResult = ReadFile(
+        server.handle,    // Mailslot handle
+        buffer,           // Buffer
+        bufferSize,       // Available buffer size
+        &read,            // Bytes read
+        NULL              // Synchronous
+    );
+    *bytesRead = read;
+    return readResult != FALSE;
+#else
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    pollfd readable = { server.handle, POLLIN, 0 };
+    while (true) {
+        int waitMs = -1;
+        if (timeoutMs != MAILSLOT_WAIT_FOREVER) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            waitMs = left > 0 ? (int)left : 0;
+        }
+        int ready = poll(&readable, 1, waitMs);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (ready == 0) {
+            errno = MAILSLOT_ERROR_TIMEOUT;
+            return false;
+        }
+
+        // A buffer smaller than the slot's limit: peek at the size first, so
+        // a datagram that does not fit stays queued (as ReadFile leaves it)
+        if (server.maxMessageSize == 0 || bufferSize < server.maxMessageSize) {
+            char probe;
+            ssize_t pending = recv(server.handle, &probe, 1, MSG_PEEK | MSG_TRUNC | MSG_DONTWAIT);
+            if (pending < 0) {
+                if (errno == EAGAIN || errno == EINTR) continue;
+                return false;
+            }
+            bool oversized = server.maxMessageSize != 0 && (uint32_t)pending > server.maxMessageSize;
+            if ((uint32_t)pending > bufferSize && !oversized) {
+                errno = MAILSLOT_ERROR_INSUFFICIENT_BUFFER;
+                return false;
+            }
+        }
+
+        // MSG_TRUNC reports the real datagram size even if it does not fit
+        ssize_t received = recv(server.handle, buffer, bufferSize, MSG_TRUNC | MSG_DONTWAIT);
+        if (received < 0) {
+            if (errno == EAGAIN || errno == EINTR) continue;
+            return false;
+        }
+        if (server.maxMessageSize != 0 && (uint32_t)received > server.maxMessageSize) {
+            server.oversizeDropped++;      // a mailslot never delivers oversized messages
+            continue;
+        }
+        *bytesRead = (uint32_t)received;
+        return true;
+    }
+#endif
+}
+
+// Receive one message, waiting up to timeoutMs
+// Returns false with MAILSLOT_ERROR_TIMEOUT when nothing arrived in time,
+// MAILSLOT_ERROR_INSUFFICIENT_BUFFER when bufferSize is below the message size.
+inline bool MailslotReceive(MailslotServer& server, char* buffer, uint32_t bufferSize,
+                            uint32_t* bytesRead, uint32_t timeoutMs) {
+    uint64_t beginNs = MailslotStatsReadBegin();
+    bool ok = MailslotReceiveOne(server, buffer, bufferSize, bytesRead, timeoutMs);
+    MailslotErrorCode error = MailslotLastError();
+    MailslotStatsReadEnd(beginNs, ok ? 1 : 0, *bytesRead);
+    if (ok) {
+        MailslotStatsMessageSize(*bytesRead);
+    } else {
+        MailslotStatsReadFailed(error);
+        MailslotSetLastError(error);
+    }
+    return ok;
+}
+
+// Receive one message using the slot's default read timeout
+inline bool MailslotReceive(MailslotServer& server, char* buffer, uint32_t bufferSize, uint32_t* bytesRead) {
+    return MailslotReceive(server, buffer, bufferSize, bytesRead, server.readTimeoutMs);
+}
+
+// Stats for one successful batched receive call
+inline void MailslotReceiveManyStats(uint64_t beginNs, const MailslotMessage* messages, uint32_t count) {
+    uint64_t bytes = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        bytes += messages[i].length;
+        MailslotStatsMessageSize(messages[i].length);
+    }
+    MailslotStatsReadEnd(beginNs, count, bytes);
+}
+
+// Receive a batch: wait up to timeoutMs for the first message, then drain
+// everything already pending (up to count) without waiting again.
+// Linux uses recvmmsg; Windows reads until GetMailslotInfo reports no message;
+// the shared-memory ring pops until empty.
+// Returns false (with *received == 0) on timeout or error.
+inline bool MailslotReceiveMany(MailslotServer& server, MailslotMessage* messages, uint32_t count,
+                                uint32_t* received, uint32_t timeoutMs) {
+    *received = 0;
+    if (count == 0) return true;
+
+    // Block 1: wait for and read the first message
+    uint64_t beginNs = MailslotStatsReadBegin();
+    if (!MailslotReceiveOne(server, messages[0].buffer, messages[0].capacity, &messages[0].length, timeoutMs)) {
+        MailslotErrorCode error = MailslotLastError();
+        MailslotStatsReadEnd(beginNs, 0, 0);
+        MailslotStatsReadFailed(error);
+        MailslotSetLastError(error);
+        return false;
+    }
+    uint32_t filled = 1;
+
+    // Block 2: drain whatever else is already queued
+    if (server.mode == MAILSLOT_MODE_SHARED_MEMORY) {
+        while (filled < count &&
+               MailslotRingTryPop(server.ring, messages[filled].buffer, messages[filled].capacity,
+                                  &messages[filled].length)) {
+            filled++;
+        }
+        *received = filled;
+        MailslotReceiveManyStats(beginNs, messages, filled);
+        return true;
+    }
+#ifdef _WIN32
+    while (filled < count) {
+        DWORD nextSize = 0;
+        if (!GetMailslotInfo(server.handle, NULL, &nextSize, NULL, NULL) ||
+            nextSize == MAILSLOT_NO_MESSAGE || nextSize > messages[filled].capacity) {
+            break;
+        }
+        DWORD read = 0;
+        if (!ReadFile(server.handle, messages[filled].buffer, messages[filled].capacity, &read, NULL)) break;
+        messages[filled].length = read;
+        filled++;
+    }
+#else
+    mmsghdr headers[MAILSLOT_BATCH_MAX];
+    iovec vectors[MAILSLOT_BATCH_MAX];
+    const uint32_t limit = server.maxMessageSize;
+    while (filled < count) {
+        // A buffer below the slot's limit: peek at the next datagram, so one
+        // that does not fit stays queued (as on Windows) and ends the batch
+        if (limit == 0 || messages[filled].capacity < limit) {
+            char probe;
+            ssize_t pending = recv(server.handle, &probe, 1, MSG_PEEK | MSG_TRUNC | MSG_DONTWAIT);
+            if (pending < 0) break;           // EAGAIN — queue drained
+            bool oversized = limit != 0 && (uint32_t)pending > limit;
+            if ((uint32_t)pending > messages[filled].capacity && !oversized) break;
+            ssize_t length = recv(server.handle, messages[filled].buffer, messages[filled].capacity,
+                                  MSG_DONTWAIT | MSG_TRUNC);
+            if (length < 0) break;
+            if (oversized) {
+                server.oversizeDropped++;      // a mailslot never delivers oversized messages
+                continue;
+            }
+            messages[filled].length = (uint32_t)length;
+            filled++;
+            continue;
+        }
+
+        // Entries that hold any datagram within the limit: one recvmmsg
+        uint32_t chunk = 0;
+        while (chunk < std::min<uint32_t>(count - filled, MAILSLOT_BATCH_MAX) &&
+               messages[filled + chunk].capacity >= limit) {
+            chunk++;
+        }
+        memset(headers, 0, sizeof(mmsghdr) * chunk);
+        for (uint32_t i = 0; i < chunk; i++) {
+            vectors[i].iov_base = messages[filled + i].buffer;
+            vectors[i].iov_len = messages[filled + i].capacity;
+            headers[i].msg_hdr.msg_iov = &vectors[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+        int got = recvmmsg(server.handle, headers, chunk, MSG_DONTWAIT | MSG_TRUNC, NULL);
+        if (got <= 0) break;                  // EAGAIN — queue drained
+
+        // Compact: drop oversized datagrams (every entry here holds the
+        // slot's limit, so anything that did not fit is above it)
+        uint32_t kept = filled;
+        for (int i = 0; i < got; i++) {
+            MailslotMessage& message = messages[filled + i];
+            uint32_t length = headers[i].msg_len;
+            if (length > limit) {
+                server.oversizeDropped++;
+                continue;
+            }
+            if (kept != filled + (uint32_t)i) memcpy(messages[kept].buffer, message.buffer, length);
+            messages[kept].length = length;
+            kept++;
+        }
+        filled = kept;
+        if ((uint32_t)got < chunk) break;
+    }
+#endif
+    *received = filled;
+    MailslotReceiveManyStats(beginNs, messages, filled);
+    return true;
+}
+
+// Batched receive using the slot's default read timeout
+inline bool MailslotReceiveMany(MailslotServer& server, MailslotMessage* messages, uint32_t count, uint32_t* received) {
+    return MailslotReceiveMany(server, messages, count, received, server.readTimeoutMs);
+}
+
+inline void MailslotClose(MailslotServer& server) {
+    if (server.mode == MAILSLOT_MODE_SHARED_MEMORY) {
+        MailslotRingClose(server.ring);
+        return;
+    }
+    if (server.handle == MAILSLOT_INVALID_HANDLE) return;
+#ifdef _WIN32
+    CloseHandle(server.handle);
+#else
+    close(server.handle);
+#endif
+    server.handle = MAILSLOT_INVALID_HANDLE;
+}
+
+// ------------------------------
+// Sender (client) endpoint
+// ------------------------------
+struct MailslotSender {
+    MailslotNativeHandle handle = MAILSLOT_INVALID_HANDLE;
+    std::string name;                 // full mailslot name
+    MailslotMode mode = MAILSLOT_MODE_KERNEL;
+    MailslotRing ring;                // MAILSLOT_MODE_SHARED_MEMORY backend
+};
+
+// Open an existing slot for writing
+// Fails with MAILSLOT_ERROR_NOT_FOUND when no server owns the slot.
+inline bool MailslotOpenSender(MailslotSender& sender, const std::string& name,
+                               MailslotMode mode = MAILSLOT_MODE_KERNEL) {
+    sender.name = name;
+    sender.mode = mode;
+    if (mode == MAILSLOT_MODE_SHARED_MEMORY) {
+        return MailslotRingOpen(sender.ring, name);
+    }
+#ifdef _WIN32
+    // CreateFileW opens the server mailslot for writing
+    // GENERIC_WRITE + FILE_SHARE_READ, mailslot must already exist (OPEN_EXISTING)
+    std::wstring wideName = MailslotWideName(name);
+    sender.handle = CreateFileW(
+        wideName.c_str(),
+        GENERIC_WRITE,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        0,
+        NULL
+    );
+    return sender.handle != INVALID_HANDLE_VALUE;
+#else
+    sockaddr_un addr;
+    socklen_t addrLen = 0;
+    if (!MailslotSocketAddress(name, &addr, &addrLen)) return false;
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    if (connect(fd, (const sockaddr*)&addr, addrLen) != 0) {
+        int error = errno;
+        close(fd);
+        // Abstract sockets report a missing peer as ECONNREFUSED
+        errno = (error == ECONNREFUSED) ? MAILSLOT_ERROR_NOT_FOUND : error;
+        return false;
+    }
+    sender.handle = fd;
+    return true;
+#endif
+}
+
+// Write one message (one datagram)
+inline bool MailslotSend(MailslotSender& sender, const void* data, uint32_t length, uint32_t* bytesWritten) {
+    *bytesWritten = 0;
+    if (sender.mode == MAILSLOT_MODE_SHARED_MEMORY) {
+        if (!MailslotRingPush(sender.ring, data, length)) return false;
+        *bytesWritten = length;
+        return true;
+    }
+#ifdef _WIN32
+    DWORD written = 0;
+    BOOL writeResult = WriteFile(
+        sender.handle,                         // mailslot handle
+        data,                                  // data pointer
+        length,                                // data length (bytes)
+        &written,                              // actually written
+        NULL                                   // synchronous I/O
+    );
+    *bytesWritten = written;
+    return writeResult != FALSE;
+#else
+    while (true) {
+        ssize_t sent = send(sender.handle, data, length, MSG_NOSIGNAL);
+        if (sent >= 0) {
+            *bytesWritten = (uint32_t)sent;
+            return true;
+        }
+        if (errno == EINTR) continue;
+        // Server went away after we connected
+        if (errno == ECONNREFUSED || errno == ENOTCONN) errno = MAILSLOT_ERROR_BROKEN_PIPE;
+        return false;
+    }
+#endif
+}
+
+// Send a batch of messages, one datagram each
+// Linux uses sendmmsg (up to MAILSLOT_BATCH_MAX per call); Windows and the
+// shared-memory ring write them one by one. *sent counts the messages that
+// went out before the first failure; returns false if any message failed.
+inline bool MailslotSendMany(MailslotSender& sender, const MailslotMessage* messages, uint32_t count,
+                             uint32_t* sent) {
+    *sent = 0;
+#ifndef _WIN32
+    if (sender.mode == MAILSLOT_MODE_KERNEL) {
+        mmsghdr headers[MAILSLOT_BATCH_MAX];
+        iovec vectors[MAILSLOT_BATCH_MAX];
+        while (*sent < count) {
+            uint32_t chunk = std::min<uint32_t>(count - *sent, MAILSLOT_BATCH_MAX);
+            memset(headers, 0, sizeof(mmsghdr) * chunk);
+            for (uint32_t i = 0; i < chunk; i++) {
+                vectors[i].iov_base = messages[*sent + i].buffer;
+                vectors[i].iov_len = messages[*sent + i].length;
+                headers[i].msg_hdr.msg_iov = &vectors[i];
+                headers[i].msg_hdr.msg_iovlen = 1;
+            }
+            int done = sendmmsg(sender.handle, headers, chunk, MSG_NOSIGNAL);
+            if (done < 0) {
+                if (errno == EINTR) continue;
+                if (errno == ECONNREFUSED || errno == ENOTCONN) errno = MAILSLOT_ERROR_BROKEN_PIPE;
+                return false;
+            }
+            *sent += (uint32_t)done;
+        }
+        return true;
+    }
+#endif
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t bytesWritten = 0;
+        if (!MailslotSend(sender, messages[i].buffer, messages[i].length, &bytesWritten)) return false;
+        (*sent)++;
+    }
+    return true;
+}
+
+inline void MailslotClose(MailslotSender& sender) {
+    if (sender.mode == MAILSLOT_MODE_SHARED_MEMORY) {
+        MailslotRingClose(sender.ring);
+        return;
+    }
+    if (sender.handle == MAILSLOT_INVALID_HANDLE) return;
+#ifdef _WIN32
+    CloseHandle(sender.handle);
+#else
+    close(sender.handle);
+#endif
+    sender.handle = MAILSLOT_INVALID_HANDLE;
+}
@@ -0,0 +1,130 @@
+#include "MailslotJournal.h"
+#include "MailslotTransport.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// ------------------------------
+// ReplayMS: stream a message journal back into a mailslot
+// Reads the segments written by ServerMS_MultiMessage --journal DIR in
+// order and sends every recorded datagram to the slot at full speed, so
+// the running server processes them with its normal handler (coalesced
+// frames stay coalesced). Payloads are sent straight from the mapped
+// segment files, in batches of up to MAILSLOT_BATCH_MAX datagrams.
+// Usage: ReplayMS DIR [--slot NAME] [--shm] [--from SEQ] [--print]
+//   --slot NAME  target slot (default Box)
+//   --shm        write into the server's shared-memory ring
+//   --from SEQ   skip records with a lower sequence number
+//   --print      print the records instead of sending them
+// ------------------------------
+
+// Send a batch, waiting while a shared-memory ring is full
+bool SendBatch(MailslotSender& sender, const MailslotMessage* batch, uint32_t count, uint64_t* errors) {
+    uint32_t done = 0;
+    while (done < count) {
+        uint32_t sent = 0;
+        if (MailslotSendMany(sender, batch + done, count - done, &sent)) return true;
+        done += sent;
+        if (MailslotLastError() == MAILSLOT_ERROR_BUSY) continue;   // ring full: retry the rest
+        HandleMailslotError("WriteFile");
+        *errors += count - done;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    MailslotInitConsole();                // Console code page
+
+    std::string directory;
+    std::string slot = "Box";
+    MailslotMode mode = MAILSLOT_MODE_KERNEL;
+    uint64_t fromSequence = 0;
+    bool print = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--slot" && i + 1 < argc) {
+            slot = argv[++i];
+        } else if (arg == "--shm") {
+            mode = MAILSLOT_MODE_SHARED_MEMORY;
+        } else if (arg == "--from" && i + 1 < argc) {
+            fromSequence = strtoull(argv[++i], NULL, 10);
+        } else if (arg == "--print") {
+            print = true;
+        } else {
+            directory = arg;
+        }
+    }
+    if (directory.empty()) {
+        std::cerr << "Usage: ReplayMS DIR [--slot NAME] [--shm] [--from SEQ] [--print]" << std::endl;
+        return 1;
+    }
+
+    // Block 1: Open the journal and the target slot
+    MailslotJournalReader reader;
+    if (!MailslotJournalReaderOpen(reader, directory)) {
+        HandleMailslotError("OpenJournal");
+        return 1;
+    }
+    MailslotSender sender;
+    if (!print && !MailslotOpenSender(sender, MailslotLocalName(slot), mode)) {
+        HandleMailslotError("CreateFile");
+        std::cout << "Make sure the server is running." << std::endl;
+        MailslotJournalReaderClose(reader);
+        return 1;
+    }
+
+    // Block 2: Stream the records
+    MailslotMessage batch[MAILSLOT_BATCH_MAX];
+    uint32_t pending = 0;
+    uint64_t records = 0, bytes = 0, gaps = 0, errors = 0;
+    uint64_t firstSequence = 0, lastSequence = 0;
+    uint64_t startNs = MailslotNowNs();
+
+    const MailslotJournalRecordHeader* header = nullptr;
+    const char* data = nullptr;
+    while (MailslotJournalReaderNext(reader, &header, &data)) {
+        if (header->sequence < fromSequence) continue;
+        if (records == 0) firstSequence = header->sequence;
+        else if (header->sequence != lastSequence + 1) gaps++;
+        lastSequence = header->sequence;
+        records++;
+        bytes += header->length;
+
+        if (print) {
+            std::cout << "[" << header->sequence << "] (" << header->length << " bytes): ";
+            std::cout.write(data, header->length);
+            std::cout << '\n';
+            continue;
+        }
+        // Point the batch into the mapped segment — no copy
+        batch[pending].buffer = const_cast<char*>(data);
+        batch[pending].capacity = header->length;
+        batch[pending].length = header->length;
+        if (++pending == MAILSLOT_BATCH_MAX) {
+            SendBatch(sender, batch, pending, &errors);
+            pending = 0;
+        }
+        // Last record of this segment: flush before the reader unmaps it
+        if (pending > 0 && MailslotJournalRecordAt(reader.segment, reader.offset) == nullptr) {
+            SendBatch(sender, batch, pending, &errors);
+            pending = 0;
+        }
+    }
+    if (pending > 0) SendBatch(sender, batch, pending, &errors);
+    double seconds = (double)(MailslotNowNs() - startNs) / 1e9;
+    MailslotJournalReaderClose(reader);
+    if (!print) MailslotClose(sender);
+
+    // Block 3: Report
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\n========== REPLAY RESULTS ==========" << std::endl;
+    std::cout << "Records: " << records << " (sequence " << firstSequence << ".." << lastSequence
+              << ", gaps: " << gaps << ")" << std::endl;
+    std::cout << "Bytes: " << bytes << ", send errors: " << errors << std::endl;
+    std::cout << "Elapsed: " << seconds << " s, "
+              << (seconds > 0 ? records / seconds : 0) << " msg/s" << std::endl;
+    std::cout << "====================================" << std::endl;
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,13 @@
+#include "MailslotSlot.h"
+
+// ------------------------------
+// ServerMS_4KB: Mailslot server for the 4 KB message size variant
+// Same as the basic server with a 4096-byte slot, for payloads that do
+// not fit the 300/500-byte variants in one message.
+// ------------------------------
+
+typedef MailslotSlot<4096, MailslotFixedTimeout<180000>, MailslotPrintHandler> ServerSlot;
+
+int main() {
+    return MailslotSingleMessageServer<ServerSlot>("Box");
+}
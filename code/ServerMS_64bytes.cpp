@@ -0,0 +1,13 @@
+#include "MailslotSlot.h"
+
+// ------------------------------
+// ServerMS_64bytes: Mailslot server for small telemetry messages
+// Same as the basic server with a 64-byte slot: the receive buffer is
+// 65 bytes and longer messages are rejected by the slot.
+// ------------------------------
+
+typedef MailslotSlot<64, MailslotFixedTimeout<180000>, MailslotPrintHandler> TelemetrySlot;
+
+int main() {
+    return MailslotSingleMessageServer<TelemetrySlot>("Box");
+}
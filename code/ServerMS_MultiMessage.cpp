@@ -1,70 +1,757 @@
-#include <windows.h>
+#include "MailslotBatch.h"
+#include "MailslotCompress.h"
+#include "MailslotCredit.h"
+#include "MailslotFragment.h"
+#include "MailslotFrame.h"
+#include "MailslotJournal.h"
+#include "MailslotLog.h"
+#include "MailslotPipeline.h"
+#include "MailslotPriority.h"
+#include "MailslotRouter.h"
+#include "MailslotStartup.h"
+#include "MailslotTransport.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <vector>
 
 // ------------------------------
 // ServerMS_MultiMessage: Mailslot server that receives many messages
 // Creates \\.\mailslot\Box, prints every received message, counts them,
 // and exits on timeout or when the window is closed.
+// Messages are printed through an asynchronous sink (see MailslotLog.h),
+// so receiving never waits on console output.
+// Binary frames (see MailslotFrame.h) are checked and unwrapped: the
+// receive thread tracks per-sender sequences (loss / reordering), the
+// CRC32C is verified before a payload is printed, and bad frames are
+// counted instead of printed. Plain text messages work as before.
+// Fragmented large messages (see MailslotFragment.h) are reassembled into
+// pooled buffers and processed once complete.
+// Compressed messages (see MailslotCompress.h) are decompressed into the
+// same pooled buffers; --dictionary must match the senders' dictionary.
+// With --route rules, messages are matched by frame type or payload prefix
+// (see MailslotRouter.h) and handled on per-route queues; "drop" rules
+// discard noise before it is queued or printed.
+// With --credits the server publishes consumed datagrams so that senders
+// with flow control (ClientMS_Performance --flow) never overrun it.
+// With --priority the slot becomes three lanes (Box.control, Box, Box.bulk,
+// see MailslotPriority.h) read through a strict or weighted scheduler, so
+// control messages do not wait behind a bulk burst. Frames whose deadline
+// passed (ClientMS_Performance --deadline-ms) are dropped unhandled.
+// With --warm every buffer and pool is faulted in and the per-message code
+// runs once before the first message (see MailslotStartup.h); --ready-file /
+// --ready-fd tell an orchestrator when the server is ready for traffic.
+// Usage: ServerMS_MultiMessage [--shm] [--pipeline N [--ordered] [--late-ms MS]]
+//                              [--stats-file PATH [--stats-interval MS]]
+//                              [--log-file PATH] [--log-policy block|drop|count]
+//                              [--journal DIR [--journal-mb N] [--durability none|periodic|group]
+//                               [--sync-ms MS]]
+//                              [--reassembly-mb N] [--reassembly-ms MS] [--credits N]
+//                              [--dictionary FILE|none]
+//                              [--route NAME:type:N|NAME:prefix:TEXT ...] [--routes FILE]
+//                              [--route-workers N]
+//                              [--priority strict|weighted [--lane-weights C,N,B]]
+//                              [--warm] [--pin CPU] [--lock-memory]
+//                              [--ready-file PATH] [--ready-fd N]
+//   --shm          shared-memory ring mode for same-host senders (see MailslotRing.h)
+//   --pipeline N   reader thread + N worker threads (see MailslotPipeline.h)
+//   --ordered      keep per-sender order in pipeline mode
+//   --late-ms MS   count messages queued longer than MS as late (default 1000)
+//   --stats-file   dump receive counters and histograms to PATH (see MailslotStats.h)
+//   --stats-interval  dump period in ms (default 1000)
+//   --log-file     write messages to PATH instead of the console
+//   --log-policy   when the log ring is full: block (default), drop, count
+//   --journal DIR  append every received datagram to memory-mapped segment
+//                  files in DIR (see MailslotJournal.h; replay with ReplayMS)
+//   --journal-mb   segment size in MB (default 64)
+//   --durability   none (default), periodic (background msync), or group
+//                  (each batch waits for the group commit before processing)
+//   --sync-ms      periodic / group commit interval (default 100)
+//   --reassembly-mb   memory cap for messages being reassembled (default 64)
+//   --reassembly-ms   drop incomplete messages after MS (default 2000)
+//   --credits N    flow control: at most N unprocessed datagrams in flight
+//                  (see MailslotCredit.h; same-host senders)
+//   --dictionary   train the decompression dictionary from a sample file
+//                  (one payload per line) or use none (default: built-in)
+//   --route        routing rule (repeatable); route "drop" discards
+//   --routes FILE  routing rules, one per line ('#' starts a comment)
+//   --route-workers  threads serving the route queues (default 2)
+//   --priority     read the control / normal / bulk lanes strictly by
+//                  priority or weighted (inline processing, kernel slots)
+//   --lane-weights weighted shares of the lanes (default 8,4,1)
+//   --warm         prefault buffers and pools, warm the message path at start
+//   --pin CPU      pin the receive thread to CPU
+//   --lock-memory  keep memory resident (mlockall / hard working-set minimum)
+//   --ready-file   write PATH (atomically) once ready, remove it on exit
+//   --ready-fd     write "READY=1" to inherited descriptor N once ready
 // ------------------------------
 
-// Error helper for Mailslot/WinAPI operations
-void HandleMailslotError(const char* operation) {
-    DWORD error = GetLastError();
-    std::cerr << "Error in operation '" << operation << "': ";
-    switch (error) {
-        case ERROR_INVALID_PARAMETER: std::cerr << "Invalid parameter"; break;
-        case ERROR_ALREADY_EXISTS:    std::cerr << "Mailslot already exists"; break;
-        case ERROR_PIPE_BUSY:         std::cerr << "Mailslot is busy"; break;
-        case ERROR_BROKEN_PIPE:       std::cerr << "Broken pipe"; break;
-        case ERROR_TIMEOUT:           std::cerr << "Timeout"; break;
-        case ERROR_INSUFFICIENT_BUFFER: std::cerr << "Insufficient buffer"; break;
-        default: std::cerr << "Error code: " << error; break;
+// Log record kinds
+const uint32_t LINE_MESSAGE = 0;        // number, tag = worker (NO_WORKER inline), payload
+const uint32_t LINE_PROGRESS = 1;       // "Processed messages: N"
+const uint32_t LINE_ROUTED = 2;         // number within the route, tag = route, payload
+const uint32_t NO_WORKER = 0xFFFFFFFFu;
+
+// Route names for LINE_ROUTED records (set before the first message)
+const MailslotRouter* loggedRoutes = NULL;
+
+// Runs on the sink thread: record -> console line
+int FormatLine(const MailslotLogRecord& record, char* out, size_t size) {
+    unsigned long long number = (unsigned long long)record.number;
+    if (record.kind == LINE_PROGRESS) return snprintf(out, size, "Processed messages: %llu\n", number);
+    if (record.kind == LINE_ROUTED) {
+        return snprintf(out, size, "[%s #%llu] Received (%u bytes): %.*s\n",
+                        loggedRoutes->routes[record.tag]->name.c_str(), number,
+                        record.length, (int)record.stored, record.data);
+    }
+    if (record.length == 0) {
+        return record.tag == NO_WORKER ? snprintf(out, size, "[%llu] Empty message\n", number)
+                                       : snprintf(out, size, "[%llu] worker %u Empty message\n", number, record.tag);
+    }
+    return record.tag == NO_WORKER
+        ? snprintf(out, size, "[%llu] Received (%u bytes): %.*s\n",
+                   number, record.length, (int)record.stored, record.data)
+        : snprintf(out, size, "[%llu] worker %u Received (%u bytes): %.*s\n",
+                   number, record.tag, record.length, (int)record.stored, record.data);
+}
+
+// Framed message counters (processing threads)
+struct FrameCounters {
+    std::atomic<uint64_t> framed{0};
+    std::atomic<uint64_t> truncated{0};
+    std::atomic<uint64_t> badVersion{0};
+    std::atomic<uint64_t> badChecksum{0};
+    std::atomic<uint64_t> expired{0};     // deadline passed before processing
+};
+
+// Receive thread: feed the sequence numbers of every frame in a datagram
+// to the tracker (header check only; the CRC is verified on processing)
+void TrackFrames(MailslotSequenceTracker& tracker, const char* data, uint32_t length) {
+    MailslotFrameReader reader;
+    MailslotFrameReaderInit(reader, data, length);
+    const char* message = NULL;
+    uint32_t bytes = 0;
+    while (MailslotFrameReaderNext(reader, &message, &bytes)) {
+        MailslotFrameView frame;
+        if (MailslotFrameDecode(message, bytes, &frame, false) == MAILSLOT_FRAME_OK) {
+            MailslotSequenceTrack(tracker, frame.header->senderId, frame.header->sequence);
+        }
+    }
+}
+
+// Ordered pipeline key: sender id of the first frame, 0 for plain text
+uint32_t SenderKey(const char* data, uint32_t length) {
+    MailslotFrameReader reader;
+    MailslotFrameReaderInit(reader, data, length);
+    const char* message = NULL;
+    uint32_t bytes = 0;
+    MailslotFrameView frame;
+    if (MailslotFrameReaderNext(reader, &message, &bytes) &&
+        MailslotFrameDecode(message, bytes, &frame, false) == MAILSLOT_FRAME_OK) {
+        return frame.header->senderId;
+    }
+    return 0;
+}
+
+// Unwrap a framed message in place (message/length -> payload; frame
+// describes the header, header == NULL for plain text).
+// Returns false for a damaged or expired frame, which is counted and skipped.
+bool CheckFrame(FrameCounters& frames, const char** message, uint32_t* length, MailslotFrameView* frame) {
+    switch (MailslotFrameDecode(*message, *length, frame)) {
+    case MAILSLOT_FRAME_NOT_FRAMED:
+        return true;
+    case MAILSLOT_FRAME_OK: {
+        frames.framed.fetch_add(1, std::memory_order_relaxed);
+        uint64_t deadlineNs = MailslotFrameDeadline(*frame);
+        if (deadlineNs != 0 && MailslotNowNs() > deadlineNs) {   // nobody waits for it any more
+            frames.expired.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        *message = frame->payload;
+        *length = frame->payloadLength;
+        return true;
+    }
+    case MAILSLOT_FRAME_TRUNCATED:
+        frames.truncated.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    case MAILSLOT_FRAME_BAD_VERSION:
+        frames.badVersion.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    default:
+        frames.badChecksum.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+}
+
+// Large and compressed messages: every processing thread shares one
+// reassembler; its pools also hold decompressed messages
+struct Reassembly {
+    MailslotReassembler reassembler;
+    std::mutex lock;
+    const MailslotDictionary* dictionary = NULL;
+    std::atomic<uint64_t> inflated{0};         // messages decompressed
+    std::atomic<uint64_t> packedBytes{0};      // compressed payload bytes
+    std::atomic<uint64_t> rawBytes{0};         // bytes after decompression
+    std::atomic<uint64_t> wrongDictionary{0};  // dictionary id differs from ours
+    std::atomic<uint64_t> corrupt{0};          // failed to decompress
+    std::atomic<uint64_t> noBuffer{0};         // no pooled buffer within the memory cap
+};
+
+// Decompress a compressed frame into a pooled buffer held by whole.
+// Returns false (counted) when it cannot be decompressed.
+bool InflateMessage(Reassembly& reassembly, const MailslotFrameView& frame, const char** message, uint32_t* length,
+                    MailslotMessageView* whole) {
+    MailslotCompressionHeader info = MailslotCompressionInfo(frame);
+    uint32_t expectedId = reassembly.dictionary != NULL ? reassembly.dictionary->id : 0;
+    if (info.dictionaryId != 0 && info.dictionaryId != expectedId) {
+        reassembly.wrongDictionary.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    MailslotMessageView inflated;
+    if (info.rawLength <= reassembly.reassembler.config.maxMessage) {
+        std::lock_guard<std::mutex> guard(reassembly.lock);
+        inflated = MailslotReassemblerBuffer(reassembly.reassembler, info.rawLength);
+    }
+    if (!inflated) {
+        reassembly.noBuffer.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    const MailslotDictionary* dictionary = info.dictionaryId != 0 ? reassembly.dictionary : NULL;
+    if (!MailslotDecompress(dictionary, frame.payload, frame.payloadLength, inflated.Data(), info.rawLength)) {
+        reassembly.corrupt.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    inflated.SetLength(info.rawLength);
+    reassembly.inflated.fetch_add(1, std::memory_order_relaxed);
+    reassembly.packedBytes.fetch_add(frame.payloadLength, std::memory_order_relaxed);
+    reassembly.rawBytes.fetch_add(info.rawLength, std::memory_order_relaxed);
+    *whole = std::move(inflated);             // frame may point into the old whole
+    *message = whole->Data();
+    *length = whole->Length();
+    return true;
+}
+
+// One received entry -> the message to process: plain text as is, a frame's
+// payload, (on its last fragment) the reassembled message, or the
+// decompressed message; the last two are held by whole.
+// *type is the frame type (kRouteTypeNone for plain text).
+// Returns false when there is nothing to process yet.
+bool UnwrapMessage(FrameCounters& frames, Reassembly& reassembly, const char** message, uint32_t* length,
+                   MailslotMessageView* whole, uint32_t* type) {
+    MailslotFrameView frame;
+    *type = kRouteTypeNone;
+    if (!CheckFrame(frames, message, length, &frame)) return false;   // damaged frame
+    if (frame.header == NULL) return true;
+    *type = frame.header->type;
+    if (MailslotIsCompressed(frame)) return InflateMessage(reassembly, frame, message, length, whole);
+    if (!MailslotIsFragment(frame)) return true;
+    {
+        std::lock_guard<std::mutex> guard(reassembly.lock);
+        if (MailslotReassemblerAdd(reassembly.reassembler, frame, whole) != MAILSLOT_REASSEMBLY_COMPLETE) {
+            return false;
+        }
+    }
+    *message = whole->Data();
+    *length = whole->Length();
+
+    // A large compressed message arrives as one compressed frame in fragments
+    MailslotFrameView inner;
+    if (MailslotFrameDecode(*message, *length, &inner) == MAILSLOT_FRAME_OK && MailslotIsCompressed(inner)) {
+        *type = inner.header->type;
+        return InflateMessage(reassembly, inner, message, length, whole);
+    }
+    return true;
+}
+
+void PrintReassemblySummary(const MailslotReassembler& reassembler) {
+    if (reassembler.fragments == 0 && reassembler.overflow == 0 && reassembler.invalid == 0) return;
+    std::cout << "Reassembly: " << reassembler.messages << " messages (" << reassembler.bytes << " bytes) from "
+              << reassembler.fragments << " fragments, expired: " << reassembler.expired
+              << ", over memory cap: " << reassembler.overflow
+              << ", invalid: " << reassembler.invalid << ", table full: " << reassembler.tableFull
+              << ", incomplete at exit: " << MailslotReassemblerPending(reassembler) << std::endl;
+}
+
+// Routing rules from --routes FILE, one per line
+bool ReadRouteFile(const std::string& path, std::vector<MailslotRouteRule>* rules) {
+    std::ifstream file(path);
+    if (!file) return false;
+    std::string line;
+    int number = 0;
+    while (std::getline(file, line)) {
+        number++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        MailslotRouteRule rule;
+        if (!MailslotRouteParse(line, &rule)) {
+            std::cout << path << ":" << number << ": invalid route rule: " << line << std::endl;
+            return false;
+        }
+        rules->push_back(rule);
+    }
+    return true;
+}
+
+// Routes that saw traffic (with hundreds of rules most stay idle)
+void PrintRouteSummary(const MailslotRouter& router, size_t ruleCount) {
+    std::cout << "Routes: " << ruleCount << " rules, " << router.routes.size() << " routes" << std::endl;
+    for (const auto& route : router.routes) {
+        if (route->matched.load() == 0) continue;
+        std::cout << "  " << route->name << ": matched " << route->matched.load() << " (" << route->bytes.load()
+                  << " bytes)";
+        if (route->drop) {
+            std::cout << ", dropped" << std::endl;
+            continue;
+        }
+        std::cout << ", handled " << route->handled.load() << ", overflow " << route->overflow.load()
+                  << ", max queue depth " << route->maxDepth.load() << std::endl;
+    }
+}
+
+void PrintCompressionSummary(const Reassembly& reassembly) {
+    uint64_t failed = reassembly.wrongDictionary.load() + reassembly.corrupt.load() + reassembly.noBuffer.load();
+    if (reassembly.inflated.load() == 0 && failed == 0) return;
+    std::cout << "Compression: " << reassembly.inflated.load() << " messages, " << reassembly.packedBytes.load()
+              << " -> " << reassembly.rawBytes.load() << " bytes, wrong dictionary: "
+              << reassembly.wrongDictionary.load() << ", corrupt: " << reassembly.corrupt.load()
+              << ", over memory cap: " << reassembly.noBuffer.load() << std::endl;
+}
+
+void PrintFrameSummary(const FrameCounters& frames, const MailslotSequenceTracker& sequences) {
+    uint64_t bad = frames.truncated.load() + frames.badVersion.load() + frames.badChecksum.load();
+    if (frames.framed.load() == 0 && bad == 0) return;
+    std::cout << "Frames: " << frames.framed.load() << " from " << sequences.senders << " senders"
+              << ", lost: " << sequences.lost << ", reordered: " << sequences.reordered
+              << ", bad checksum: " << frames.badChecksum.load() << ", truncated: " << frames.truncated.load()
+              << ", bad version: " << frames.badVersion.load() << ", expired: " << frames.expired.load() << std::endl;
+}
+
+void PrintLaneSummary(const MailslotLaneSet& lanes) {
+    std::cout << "Lanes (" << (lanes.config.scheduling == MAILSLOT_LANES_STRICT ? "strict" : "weighted") << "):";
+    for (uint32_t i = 0; i < kPriorityLanes; i++) {
+        std::cout << (i == 0 ? " " : ", ") << MailslotPriorityName(i) << " " << lanes.lanes[i].datagrams
+                  << " datagrams in " << lanes.lanes[i].picks << " reads";
+    }
+    std::cout << std::endl;
+}
+
+// Readiness: published once the server takes traffic (after the warm-up)
+struct Readiness {
+    uint64_t startNs = 0;                  // main() entered
+    std::string slot;
+    std::string file;                      // --ready-file, empty — none
+    intptr_t fd = -1;                      // --ready-fd, -1 — none
+};
+
+void SignalReady(const Readiness& ready) {
+    double startupMs = (MailslotNowNs() - ready.startNs) / 1e6;
+    if (!ready.file.empty() && !MailslotReadyFile(ready.file, ready.slot, startupMs)) HandleMailslotError("WriteReadyFile");
+    if (ready.fd >= 0 && !MailslotReadyFd(ready.fd)) HandleMailslotError("WriteReadyFd");
+    std::cout << "Ready in " << startupMs << " ms" << std::endl;
+}
+
+// --warm: fault in the reassembly pools and run the per-message code once
+// (CRC32C dispatch, frame decode, decompression tables), so none of it
+// lands on the first messages. The log ring and output buffer, pipeline
+// and route pools are faulted in when they are created (config.prefault).
+void WarmUp(Reassembly& reassembly) {
+    for (auto& pool : reassembly.reassembler.pools) pool->Prefault();
+    static const char sample[] = "Hello from Maislot-client";
+    char frame[256];
+    memcpy(MailslotFramePayload(frame), sample, sizeof(sample) - 1);
+    uint32_t length = MailslotFrameSeal(frame, 0, 0, sizeof(sample) - 1);
+    MailslotFrameView view;
+    MailslotFrameDecode(frame, length, &view);
+    char packed[128], raw[sizeof(sample)];
+    uint32_t packedLength = MailslotCompress(reassembly.dictionary, sample, sizeof(sample) - 1, packed, sizeof(packed));
+    if (packedLength > 0) MailslotDecompress(reassembly.dictionary, packed, packedLength, raw, sizeof(sample) - 1);
+}
+
+// Close the slot, or every lane with --priority (unopened ones are skipped)
+void CloseSlot(MailslotServer& server, MailslotLaneSet& lanes) {
+    MailslotClose(server);
+    MailslotLanesClose(lanes);
+}
+
+// Journal mode: append the raw datagrams of one batch; with group commit
+// the batch is processed only after it is on disk
+void JournalBatch(MailslotJournal& journal, const MailslotMessage* messages, uint32_t count) {
+    static int reportedErrors = 0;
+    uint64_t sequence = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!MailslotJournalAppend(journal, messages[i].buffer, messages[i].length, &sequence) &&
+            reportedErrors++ < 5) {
+            HandleMailslotError("WriteJournal");
+        }
+    }
+    MailslotJournalWaitDurable(journal, sequence);
+}
+
+// --credits: the transport drops oversized datagrams before the server sees
+// them; return their credits as well (total — the slot's counter)
+void ConsumeOversize(MailslotCreditChannel& credit, uint64_t total, uint64_t* seen) {
+    if (total == *seen) return;
+    MailslotCreditConsume(credit, (uint32_t)(total - *seen));
+    *seen = total;
+}
+
+// Pipeline mode: this thread only reads, workers hand messages to the log
+// Returns the number of processed messages.
+uint64_t RunPipeline(MailslotServer& server, const MailslotPipelineConfig& config, MailslotLog& log,
+                     FrameCounters& frames, Reassembly& reassembly, MailslotCreditChannel* credit,
+                     MailslotRouter* router, const Readiness& ready) {
+    std::atomic<uint64_t> messageCount{0};
+    MailslotPipeline pipeline;
+    MailslotPipelineStart(pipeline, config, MailslotMaxMessageSize(server),
+        [&messageCount, &log, &frames, &reassembly, credit, router](const MailslotMessageView& received,
+                                                                     uint32_t worker) {
+            MailslotFrameReader reader;
+            MailslotFrameReaderInit(reader, received.Data(), received.Length());
+            const char* message = NULL;
+            uint32_t bytesRead = 0;
+            while (MailslotFrameReaderNext(reader, &message, &bytesRead)) {
+                MailslotMessageView whole;
+                uint32_t type = kRouteTypeNone;
+                if (!UnwrapMessage(frames, reassembly, &message, &bytesRead, &whole, &type)) continue;
+                uint64_t number = messageCount.fetch_add(1, std::memory_order_relaxed) + 1;
+                if (router != NULL) {
+                    MailslotRouterDispatch(*router, type, message, bytesRead, &whole);
+                    continue;
+                }
+                MailslotLogWrite(log, LINE_MESSAGE, number, worker, message, bytesRead);
+            }
+            if (credit != NULL) MailslotCreditConsume(*credit, 1);   // datagram done
+        });
+
+    SignalReady(ready);                       // workers and pool are up
+    MailslotPipelineRun(pipeline, server);    // returns after timeout/error, workers drained
+    MailslotErrorCode error = MailslotLastError();
+    if (router != NULL) MailslotRouterStop(*router);   // route queues drained
+    MailslotLogClose(log);                    // everything queued is printed first
+    if (error == MAILSLOT_ERROR_TIMEOUT) {
+        std::cout << "\nMessage wait timeout (3 minutes)" << std::endl;
+    } else {
+        MailslotSetLastError(error);
+        HandleMailslotError("ReadFile");
     }
-    std::cerr << std::endl;
+
+    // Pipeline counters
+    std::cout << "Received: " << pipeline.stats.received.load()
+              << ", processed: " << pipeline.stats.processed.load()
+              << ", dropped: " << pipeline.stats.dropped.load()
+              << ", late: " << pipeline.stats.late.load()
+              << ", max queue depth: " << pipeline.stats.maxDepth.load()
+              << ", pool high-water: " << pipeline.pool->HighWater() << " / " << pipeline.pool->BlockCount()
+              << std::endl;
+    return messageCount.load();
 }
 
-int main() {
-    SetConsoleCP(1251);                // Console input code page
-    SetConsoleOutputCP(1251);          // Console output code page
+int main(int argc, char* argv[]) {
+    Readiness ready;
+    ready.startNs = MailslotNowNs();
+    MailslotInitConsole();             // Console code page
+
+    MailslotMode mode = MAILSLOT_MODE_KERNEL;
+    MailslotPipelineConfig pipelineConfig;
+    uint32_t pipelineWorkers = 0;      // 0 — inline processing
+    std::string statsFile;             // empty — no periodic dump
+    uint32_t statsIntervalMs = 1000;
+    std::string logFile;               // empty — console
+    MailslotLogConfig logConfig;
+    MailslotJournalConfig journalConfig;  // directory empty — no journal
+    FrameCounters frames;
+    static MailslotSequenceTracker sequences;  // receive thread only
+    MailslotSequenceReset(sequences);
+    MailslotReassemblyConfig reassemblyConfig;
+    uint32_t creditWindow = 0;         // 0 — no flow control
+    std::string dictionaryFile;        // empty — built-in dictionary
+    std::vector<MailslotRouteRule> routeRules;
+    MailslotRouterConfig routerConfig;
+    bool prioritized = false;          // --priority: control / normal / bulk lanes
+    MailslotLaneConfig laneConfig;
+    bool warm = false;                 // --warm: prefault and warm up before traffic
+    int pinCpu = -1;                   // -1 — no pinning
+    bool lockMemory = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--shm") {
+            mode = MAILSLOT_MODE_SHARED_MEMORY;
+        } else if (arg == "--pipeline" && i + 1 < argc) {
+            pipelineWorkers = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--ordered") {
+            pipelineConfig.ordered = true;
+        } else if (arg == "--late-ms" && i + 1 < argc) {
+            pipelineConfig.lateMs = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--stats-file" && i + 1 < argc) {
+            statsFile = argv[++i];
+        } else if (arg == "--stats-interval" && i + 1 < argc) {
+            statsIntervalMs = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--log-file" && i + 1 < argc) {
+            logFile = argv[++i];
+        } else if (arg == "--log-policy" && i + 1 < argc) {
+            std::string policy = argv[++i];
+            logConfig.policy = policy == "drop"  ? MAILSLOT_LOG_DROP
+                             : policy == "count" ? MAILSLOT_LOG_COUNT
+                                                 : MAILSLOT_LOG_BLOCK;
+        } else if (arg == "--journal" && i + 1 < argc) {
+            journalConfig.directory = argv[++i];
+        } else if (arg == "--journal-mb" && i + 1 < argc) {
+            journalConfig.segmentSize = strtoull(argv[++i], NULL, 10) << 20;
+        } else if (arg == "--durability" && i + 1 < argc) {
+            std::string durability = argv[++i];
+            journalConfig.durability = durability == "periodic" ? MAILSLOT_DURABILITY_PERIODIC
+                                     : durability == "group"    ? MAILSLOT_DURABILITY_GROUP
+                                                                : MAILSLOT_DURABILITY_NONE;
+        } else if (arg == "--sync-ms" && i + 1 < argc) {
+            journalConfig.syncIntervalMs = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--reassembly-mb" && i + 1 < argc) {
+            reassemblyConfig.memoryCap = strtoull(argv[++i], NULL, 10) << 20;
+        } else if (arg == "--reassembly-ms" && i + 1 < argc) {
+            reassemblyConfig.timeoutMs = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--credits" && i + 1 < argc) {
+            creditWindow = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--dictionary" && i + 1 < argc) {
+            dictionaryFile = argv[++i];
+        } else if (arg == "--route" && i + 1 < argc) {
+            MailslotRouteRule rule;
+            if (!MailslotRouteParse(argv[++i], &rule)) {
+                std::cout << "Invalid route rule: " << argv[i] << " (NAME:type:N or NAME:prefix:TEXT)" << std::endl;
+                return 1;
+            }
+            routeRules.push_back(rule);
+        } else if (arg == "--routes" && i + 1 < argc) {
+            if (!ReadRouteFile(argv[++i], &routeRules)) {
+                std::cout << "Cannot read route rules: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--route-workers" && i + 1 < argc) {
+            routerConfig.workers = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--priority" && i + 1 < argc) {
+            prioritized = true;
+            laneConfig.scheduling = std::string(argv[++i]) == "weighted" ? MAILSLOT_LANES_WEIGHTED
+                                                                         : MAILSLOT_LANES_STRICT;
+        } else if (arg == "--lane-weights" && i + 1 < argc) {
+            unsigned control = 0, normal = 0, bulk = 0;
+            if (sscanf(argv[++i], "%u,%u,%u", &control, &normal, &bulk) != 3) {
+                std::cout << "Invalid lane weights: " << argv[i] << " (C,N,B)" << std::endl;
+                return 1;
+            }
+            laneConfig.weights[MAILSLOT_PRIORITY_CONTROL] = control;
+            laneConfig.weights[MAILSLOT_PRIORITY_NORMAL] = normal;
+            laneConfig.weights[MAILSLOT_PRIORITY_BULK] = bulk;
+        } else if (arg == "--warm") {
+            warm = true;
+        } else if (arg == "--pin" && i + 1 < argc) {
+            pinCpu = atoi(argv[++i]);
+        } else if (arg == "--lock-memory") {
+            lockMemory = true;
+        } else if (arg == "--ready-file" && i + 1 < argc) {
+            ready.file = argv[++i];
+        } else if (arg == "--ready-fd" && i + 1 < argc) {
+            ready.fd = (intptr_t)strtoll(argv[++i], NULL, 10);
+        }
+    }
+    // Lanes are read inline: the pipeline queue is FIFO again
+    if (prioritized && (pipelineWorkers > 0 || mode == MAILSLOT_MODE_SHARED_MEMORY)) {
+        std::cout << "--priority needs inline processing on kernel slots (no --pipeline, no --shm)" << std::endl;
+        return 1;
+    }
+
+    // Pinned before anything is allocated: memory is first touched on that CPU
+    if (pinCpu >= 0 && !MailslotPinThread((uint32_t)pinCpu)) HandleMailslotError("SetThreadAffinity");
+    pipelineConfig.prefault = warm;
+    logConfig.prefault = warm;
+    routerConfig.prefault = warm;
 
     // Block 1: Create Mailslot (local \\. prefix)
-    LPCWSTR mailslotName = L"\\\\.\\mailslot\\Box";
-    HANDLE hMailslot = NULL;
+    std::string mailslotName = MailslotLocalName("Box");
+    ready.slot = mailslotName;
+    MailslotServer server;
+    MailslotLaneSet lanes;             // --priority: Box.control, Box, Box.bulk
     
     // 3‑minute timeout allows graceful exit when no client is present
-    hMailslot = CreateMailslot(
-        mailslotName,  // Full mailslot name
-        300,           // Max incoming message size (bytes)
-        180000,        // Read timeout in ms (3 minutes)
-        NULL           // Default security attributes
-    );
-    if (hMailslot == INVALID_HANDLE_VALUE) { HandleMailslotError("CreateMailslot"); return 1; }
-
-    std::cout << "Mailslot created" << std::endl;
+    if (prioritized) {
+        if (!MailslotLanesCreate(lanes, mailslotName, 300, 180000, laneConfig)) {
+            HandleMailslotError("CreateMailslot");
+            return 1;
+        }
+    } else if (!MailslotCreate(
+            server,        // Server endpoint
+            mailslotName,  // Full mailslot name
+            300,           // Max incoming message size (bytes)
+            180000,        // Read timeout in ms (3 minutes)
+            mode)) {       // Kernel slot or shared-memory ring
+        HandleMailslotError("CreateMailslot");
+        return 1;
+    }
+
+    std::cout << "Mailslot created" << (mode == MAILSLOT_MODE_SHARED_MEMORY ? " (shared memory)" : "") << std::endl;
+    if (prioritized) {
+        std::cout << "Priority lanes (" << (laneConfig.scheduling == MAILSLOT_LANES_STRICT ? "strict" : "weighted")
+                  << "): " << MailslotPriorityLaneName(mailslotName, MAILSLOT_PRIORITY_CONTROL) << ", "
+                  << mailslotName << ", " << MailslotPriorityLaneName(mailslotName, MAILSLOT_PRIORITY_BULK)
+                  << std::endl;
+    }
     std::cout << "Waiting for client messages..." << std::endl;
     std::cout << "Press Ctrl+C or close the window to exit" << std::endl;
+
+    // Flow control channel next to the slot
+    MailslotCreditChannel creditChannel;
+    MailslotCreditChannel* credit = NULL;
+    if (creditWindow > 0) {
+        if (!MailslotCreditCreate(creditChannel, mailslotName, creditWindow)) {
+            HandleMailslotError("CreateFileMapping");
+            CloseSlot(server, lanes);
+            return 1;
+        }
+        credit = &creditChannel;
+        std::cout << "Flow control: " << creditWindow << " credits" << std::endl;
+    }
+
+    MailslotStatsDumper statsDumper;
+    if (!statsFile.empty()) MailslotStatsDumperStart(statsDumper, statsFile, statsIntervalMs);
+
+    // Message output: formatted and written by the sink thread
+    MailslotLog log;
+    if (!MailslotLogOpen(log, logFile, logConfig, FormatLine)) {
+        HandleMailslotError("CreateFile");
+        if (credit != NULL) MailslotCreditClose(creditChannel);
+        CloseSlot(server, lanes);
+        return 1;
+    }
+
+    // Reassembly buffers for fragmented messages (allocated once)
+    Reassembly reassembly;
+    MailslotReassemblerInit(reassembly.reassembler, reassemblyConfig);
+
+    // Decompression dictionary (the same as the senders')
+    MailslotDictionary trained;
+    reassembly.dictionary = &MailslotDefaultDictionary();
+    if (dictionaryFile == "none") {
+        reassembly.dictionary = NULL;
+    } else if (!dictionaryFile.empty()) {
+        if (!MailslotDictionaryTrainFile(trained, dictionaryFile)) {
+            std::cout << "Cannot read dictionary samples: " << dictionaryFile << std::endl;
+            MailslotLogClose(log);
+            if (credit != NULL) MailslotCreditClose(creditChannel);
+            CloseSlot(server, lanes);
+            return 1;
+        }
+        reassembly.dictionary = &trained;
+    }
+
+    // Optional journal of everything received
+    MailslotJournal journal;
+    bool journaling = !journalConfig.directory.empty();
+    if (journaling) {
+        if (!MailslotJournalOpen(journal, journalConfig)) {
+            HandleMailslotError("OpenJournal");
+            MailslotLogClose(log);
+            if (credit != NULL) MailslotCreditClose(creditChannel);
+            CloseSlot(server, lanes);
+            return 1;
+        }
+        std::cout << "Journal: " << journalConfig.directory << ", segment " << journal.segmentIndex
+                  << ", next sequence " << journal.sequence + 1 << std::endl;
+    }
+
+    // Routing: rules compiled once, route workers print through the log
+    MailslotRouter routerTable;
+    MailslotRouter* router = NULL;
+    if (!routeRules.empty()) {
+        MailslotRouterCompile(routerTable, routeRules);
+        loggedRoutes = &routerTable;
+        MailslotRouterStart(routerTable, routerConfig,
+                            MailslotMaxMessageSize(prioritized ? lanes.lanes[MAILSLOT_PRIORITY_NORMAL].server : server),
+            [&log](uint32_t route, uint32_t, const MailslotMessageView& message) {
+                uint64_t number = loggedRoutes->routes[route]->handled.load(std::memory_order_relaxed) + 1;
+                MailslotLogWrite(log, LINE_ROUTED, number, route, message.Data(), message.Length());
+            });
+        router = &routerTable;
+        std::cout << "Routing: " << routeRules.size() << " rules, " << routerTable.routes.size() << " routes"
+                  << std::endl;
+    }
+
+    // Warm start: everything faulted in (and locked) before readiness
+    if (warm) WarmUp(reassembly);
+    if (lockMemory && !MailslotLockMemory(reassemblyConfig.memoryCap + (16u << 20))) {
+        HandleMailslotError("LockMemory");    // not fatal: runs unlocked
+    }
+
+    if (pipelineWorkers > 0) {
+        // The reader thread tracks sequences (and journals) before handing
+        // the batch to the workers; --ordered keeps each sender on one worker
+        // (plain text messages share key 0)
+        uint64_t oversizeSeen = 0;
+        pipelineConfig.tap = [&journal, journaling, &server, credit, &oversizeSeen](const MailslotMessage* messages,
+                                                                                   uint32_t count) {
+            for (uint32_t i = 0; i < count; i++) TrackFrames(sequences, messages[i].buffer, messages[i].length);
+            if (journaling) JournalBatch(journal, messages, count);
+            if (credit != NULL) ConsumeOversize(*credit, server.oversizeDropped, &oversizeSeen);
+        };
+        if (credit != NULL) {                 // dropped datagrams return their credits
+            pipelineConfig.onDrop = [credit](uint32_t count) { MailslotCreditConsume(*credit, count); };
+        }
+        pipelineConfig.keyOf = SenderKey;
+        pipelineConfig.workers = pipelineWorkers;
+        uint64_t processed = RunPipeline(server, pipelineConfig, log, frames, reassembly, credit, router, ready);
+        MailslotReadyClear(ready.file);
+        MailslotClose(server);
+        if (credit != NULL) MailslotCreditClose(creditChannel);
+        if (journaling) MailslotJournalClose(journal);
+        MailslotStatsDumperStop(statsDumper);
+        MailslotStatsPrintSummary(std::cout);
+        PrintFrameSummary(frames, sequences);
+        PrintReassemblySummary(reassembly.reassembler);
+        PrintCompressionSummary(reassembly);
+        if (router != NULL) PrintRouteSummary(*router, routeRules.size());
+        std::cout << "Log: " << log.written.load() << " records in " << log.writes.load()
+                  << " writes, dropped: " << log.dropped.load() << std::endl;
+        if (journaling) {
+            std::cout << "Journal: " << journal.records.load() << " records, " << journal.segments.load()
+                      << " segments, " << journal.syncs.load() << " syncs" << std::endl;
+        }
+        std::cout << "\nServer shutting down. Total messages: " << processed << std::endl;
+        return 0;
+    }
     
-    // Block 2: Loop reading multiple messages
-    char buffer[512];                   // Read buffer (margin above 300 bytes)
-    DWORD bytesRead = 0;                // Actual read size
-    int messageCount = 0;               // Message counter
+    // Block 2: Loop reading messages in batches
+    // One receive call drains every pending message (up to BATCH_SIZE);
+    // messages are copied into the log ring and printed by the sink thread.
+    const uint32_t BATCH_SIZE = MAILSLOT_BATCH_MAX;
+    static char buffers[BATCH_SIZE][512];   // Read buffers (margin above 300 bytes)
+    MailslotMessage batch[BATCH_SIZE];
+    for (uint32_t i = 0; i < BATCH_SIZE; i++) {
+        batch[i].buffer = buffers[i];
+        batch[i].capacity = sizeof(buffers[i]);
+        batch[i].length = 0;
+    }
+    uint32_t received = 0;              // Messages in the current batch
+    uint32_t lane = 0;                  // --priority: lane of the batch
+    uint64_t messageCount = 0;          // Message counter
+    uint64_t oversizeSeen = 0;          // --credits: oversized datagrams already returned
+    bool timedOut = false;
+    if (warm) MailslotPrefault(buffers, sizeof(buffers));
+    SignalReady(ready);
     
     while (true) {
-        // ReadFile blocks until data is available or timeout occurs
-        BOOL readResult = ReadFile(
-            hMailslot,                  // server handle
-            buffer,                     // destination buffer
-            sizeof(buffer) - 1,         // leave space for trailing '\0'
-            &bytesRead,                 // bytes read
-            NULL                        // synchronous I/O
-        );
+        // MailslotReceiveMany blocks until data is available or timeout occurs;
+        // with lanes the scheduler picks which lane the batch comes from
+        bool readResult = prioritized
+            ? MailslotLanesReceive(lanes, batch, BATCH_SIZE, &received, &lane)
+            : MailslotReceiveMany(
+                  server,               // server endpoint
+                  batch,                // destination buffers
+                  BATCH_SIZE,           // batch capacity
+                  &received             // messages received
+              );
         
-        if (readResult == FALSE) {
-            DWORD error = GetLastError();
-            if (error == ERROR_TIMEOUT) {        // Exit when no messages for 3 minutes
-                std::cout << "\nMessage wait timeout (3 minutes)" << std::endl;
-                std::cout << "Total messages received: " << messageCount << std::endl;
+        if (!readResult) {
+            if (MailslotLastError() == MAILSLOT_ERROR_TIMEOUT) { // Exit when no messages for 3 minutes
+                timedOut = true;
                 break;
             } else {
                 HandleMailslotError("ReadFile");
@@ -72,23 +759,63 @@ int main() {
             }
         }
         
-        // Block 3: Process each message
-        messageCount++;
-        if (bytesRead > 0) {
-            buffer[bytesRead] = '\0';
-            std::cout << "[" << messageCount << "] Received (" << bytesRead << " bytes): " << buffer << std::endl;
-        } else {
-            std::cout << "[" << messageCount << "] Empty message" << std::endl;
+        if (journaling) JournalBatch(journal, batch, received);
+
+        // Block 3: Process each message of the batch
+        // Coalesced frames from batched clients are unpacked transparently
+        for (uint32_t i = 0; i < received; i++) {
+            TrackFrames(sequences, batch[i].buffer, batch[i].length);
+            MailslotFrameReader reader;
+            MailslotFrameReaderInit(reader, batch[i].buffer, batch[i].length);
+            const char* message = NULL;
+            uint32_t bytesRead = 0;
+            while (MailslotFrameReaderNext(reader, &message, &bytesRead)) {
+                MailslotMessageView whole;    // reassembled large message
+                uint32_t type = kRouteTypeNone;
+                if (!UnwrapMessage(frames, reassembly, &message, &bytesRead, &whole, &type)) continue;
+                messageCount++;
+                if (router != NULL) {
+                    MailslotRouterDispatch(*router, type, message, bytesRead, &whole);
+                } else {
+                    MailslotLogWrite(log, LINE_MESSAGE, messageCount, NO_WORKER, message, bytesRead);
+                }
+                
+                // Progress every 100 messages
+                if (messageCount % 100 == 0) {
+                    MailslotLogWrite(log, LINE_PROGRESS, messageCount, NO_WORKER, NULL, 0);
+                }
+            }
         }
-        
-        // Progress every 100 messages
-        if (messageCount % 100 == 0) {
-            std::cout << "Processed messages: " << messageCount << std::endl;
+        if (credit != NULL) {
+            MailslotCreditConsume(*credit, received);  // batch processed
+            ConsumeOversize(*credit, prioritized ? MailslotLanesOversizeDropped(lanes) : server.oversizeDropped,
+                            &oversizeSeen);
         }
     }
     
-    CloseHandle(hMailslot);             // Release server handle
+    MailslotReadyClear(ready.file);     // No longer taking traffic
+    CloseSlot(server, lanes);           // Release server endpoint (or lanes)
+    if (credit != NULL) MailslotCreditClose(creditChannel);
+    if (journaling) MailslotJournalClose(journal);  // Flush the journal tail
+    if (router != NULL) MailslotRouterStop(*router);   // Drain the route queues
+    MailslotLogClose(log);              // Print everything still queued
+    if (timedOut) {
+        std::cout << "\nMessage wait timeout (3 minutes)" << std::endl;
+        std::cout << "Total messages received: " << messageCount << std::endl;
+    }
+    MailslotStatsDumperStop(statsDumper);  // final snapshot stays in the file
+    MailslotStatsPrintSummary(std::cout);
+    PrintFrameSummary(frames, sequences);
+    PrintReassemblySummary(reassembly.reassembler);
+    PrintCompressionSummary(reassembly);
+    if (router != NULL) PrintRouteSummary(*router, routeRules.size());
+    if (prioritized) PrintLaneSummary(lanes);
+    std::cout << "Log: " << log.written.load() << " records in " << log.writes.load()
+              << " writes, dropped: " << log.dropped.load() << std::endl;
+    if (journaling) {
+        std::cout << "Journal: " << journal.records.load() << " records, " << journal.segments.load()
+                  << " segments, " << journal.syncs.load() << " syncs" << std::endl;
+    }
     std::cout << "\nServer shutting down. Total messages: " << messageCount << std::endl;
     return 0;
 }
-
@@ -0,0 +1,106 @@
+#include "MailslotBatch.h"
+#include "MailslotEventLoop.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// ------------------------------
+// ServerMS_MultiSlot: one server process for many mailslots
+// Creates \\.\mailslot\<Name> for every name on the command line and
+// services all of them from a single event loop thread. Every slot prints
+// its own messages and closes after its own idle timeout; the server exits
+// when the last slot is closed.
+// Usage: ServerMS_MultiSlot [--timeout MS] [--max BYTES]
+//                          [--stats-file PATH [--stats-interval MS]] Name[:TIMEOUT_MS] ...
+//   default: a single slot "Box" with a 3-minute timeout
+//   --stats-file  dump receive counters and histograms to PATH (see MailslotStats.h)
+// ------------------------------
+
+int main(int argc, char* argv[]) {
+    MailslotInitConsole();                // Console code page
+
+    uint32_t defaultTimeoutMs = 180000;   // Per-slot idle timeout (3 minutes)
+    uint32_t maxMessageSize = 300;        // Max incoming message size (bytes)
+    std::vector<std::string> names;       // Slot[:timeout] specs
+    std::string statsFile;                // empty — no periodic dump
+    uint32_t statsIntervalMs = 1000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--timeout" && i + 1 < argc) {
+            defaultTimeoutMs = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (arg == "--max" && i + 1 < argc) {
+            maxMessageSize = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (arg == "--stats-file" && i + 1 < argc) {
+            statsFile = argv[++i];
+        } else if (arg == "--stats-interval" && i + 1 < argc) {
+            statsIntervalMs = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else {
+            names.push_back(arg);
+        }
+    }
+    if (names.empty()) names.push_back("Box");
+
+    // Block 1: Create every slot and register it with the loop
+    MailslotEventLoop loop;
+    if (!MailslotLoopInit(loop)) { HandleMailslotError("CreateIoCompletionPort"); return 1; }
+
+    // Messages per slot (slot.messageCount counts datagrams; a coalesced
+    // datagram carries several messages)
+    std::vector<uint64_t> messageCounts(names.size(), 0);
+
+    // Per-slot dispatch: print every message (coalesced frames unpacked)
+    MailslotMessageHandler onMessage = [&messageCounts](MailslotLoopSlot& slot, const char* data, uint32_t length) {
+        MailslotFrameReader reader;
+        MailslotFrameReaderInit(reader, data, length);
+        const char* message = NULL;
+        uint32_t messageLength = 0;
+        while (MailslotFrameReaderNext(reader, &message, &messageLength)) {
+            uint64_t number = ++messageCounts[slot.index];
+            std::cout << slot.server.name << " [" << number << "] Received ("
+                      << messageLength << " bytes): ";
+            std::cout.write(message, messageLength);
+            std::cout << '\n';
+        }
+    };
+    // Per-slot timeout: report and close the slot
+    MailslotTimeoutHandler onTimeout = [&messageCounts](MailslotLoopSlot& slot) {
+        std::cout << slot.server.name << ": message wait timeout (" << slot.timeoutMs << " ms), total messages: "
+                  << messageCounts[slot.index] << std::endl;
+        return false;
+    };
+
+    for (size_t i = 0; i < names.size(); i++) {
+        std::string slotName = names[i];
+        uint32_t timeoutMs = defaultTimeoutMs;
+        size_t colon = slotName.find(':');
+        if (colon != std::string::npos) {
+            timeoutMs = (uint32_t)strtoul(slotName.c_str() + colon + 1, NULL, 10);
+            slotName.resize(colon);
+        }
+        if (MailslotLoopAdd(loop, MailslotLocalName(slotName), maxMessageSize, timeoutMs, onMessage, onTimeout) < 0) {
+            HandleMailslotError("CreateMailslot");
+            MailslotLoopClose(loop);
+            return 1;
+        }
+    }
+
+    std::cout << "Mailslots created: " << names.size() << std::endl;
+    std::cout << "Waiting for client messages..." << std::endl;
+    std::cout << "Press Ctrl+C or close the window to exit" << std::endl;
+
+    MailslotStatsDumper statsDumper;
+    if (!statsFile.empty()) MailslotStatsDumperStart(statsDumper, statsFile, statsIntervalMs);
+
+    // Block 2: Service all slots from this thread
+    bool ok = MailslotLoopRun(loop);
+    if (!ok) HandleMailslotError("GetQueuedCompletionStatus");
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < messageCounts.size(); i++) total += messageCounts[i];
+    MailslotLoopClose(loop);
+    MailslotStatsDumperStop(statsDumper);
+    std::cout << "\nServer shutting down. Total messages: " << total << std::endl;
+    MailslotStatsPrintSummary(std::cout);
+    return ok ? 0 : 1;
+}